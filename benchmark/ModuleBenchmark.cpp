@@ -0,0 +1,552 @@
+#include "Module.h"
+#include "ModuleMgr.h"
+#include "ModuleItemVisitor.h"
+#include "ModuleStatic.h"
+#include "Modules.h"
+
+#include "Entities/Player.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+namespace cmangos_module
+{
+    namespace benchmark
+    {
+        struct Options
+        {
+            uint32 modules = 10;
+            uint32 subscribers = 10;
+            uint32 iterations = 1000000;
+            uint32 repetitions = 5;
+            bool csv = false;
+        };
+
+        Options options;
+
+        class BenchmarkModule;
+        const BenchmarkModule* firstModule = nullptr;
+
+        // Entry of the training dummies the modules handle on OnAddToWorld (one per module)
+        constexpr uint32 BENCHMARK_DUMMY_ENTRY = 31144;
+        // Set once the unfiltered grid load is measured, the modules then filter OnAddToWorld on their dummy
+        bool filterCreatures = false;
+
+        // Data a module keeps per player
+        struct BenchmarkPlayerData
+        {
+            uint64 damage = 0;
+            uint32 kills = 0;
+        };
+
+        // Data a module keeps per creature
+        struct BenchmarkCreatureData
+        {
+            uint32 respawns = 0;
+            uint32 lastRespawnTime = 0;
+        };
+
+        // Synthetic module that implements the benchmarked hooks with trivial bodies
+        class BenchmarkModule : public Module
+        {
+        public:
+            BenchmarkModule(uint32 index, bool subscribed)
+            : Module("Benchmark" + std::to_string(index), nullptr)
+            , index(index)
+            , subscribed(subscribed)
+            , commandPrefix("bench" + std::to_string(index))
+            , counter(0)
+            , playerData(RegisterPlayerState<BenchmarkPlayerData>())
+            {
+                if (!firstModule)
+                {
+                    firstModule = this;
+                }
+
+                if (subscribed)
+                {
+                    RegisterHooks({ ModuleHook::OnDealDamage, ModuleHook::OnCalculateEffectiveCritChance, ModuleHook::OnGossipSelect, ModuleHook::OnSaveToDB });
+                    RegisterDeferredHook(ModuleHook::OnDealHeal);
+                    RegisterSpellHook(ModuleHook::OnCast, { 10000 + index });
+                    RegisterHook(ModuleHook::OnAddToWorld);
+                }
+                else
+                {
+                    RegisterHook(ModuleHook::OnLogOut);
+                }
+
+                for (uint32 i = 0; i < 8; ++i)
+                {
+                    ModuleChatCommand command;
+                    command.name = "command" + std::to_string(i);
+                    command.callback = [this](WorldSession*, const std::string& args) { counter += args.size(); return true; };
+                    command.securityLevel = SEC_PLAYER;
+                    commandTable.push_back(std::move(command));
+                }
+
+                // Nested command with typed arguments: "benchN typed give <target> <amount>"
+                ModuleChatCommand give;
+                give.name = "give";
+                give.securityLevel = SEC_PLAYER;
+                give.arguments = { { "target", ModuleCommandArg::PlayerName, false }, { "amount", ModuleCommandArg::UInt, false } };
+                give.handler = [this](WorldSession*, const ModuleCommandArgs& args) { counter += args.GetUInt(1); return true; };
+                ModuleChatCommand typed;
+                typed.name = "typed";
+                typed.securityLevel = SEC_PLAYER;
+                typed.subcommands.push_back(std::move(give));
+                commandTable.push_back(std::move(typed));
+            }
+
+            void OnDealDamage(Unit* unit, Unit* victim, uint32 health, uint32 damage) override { counter += damage; }
+            bool OnCalculateEffectiveCritChance(const Unit* unit, const Unit* victim, uint8 attType, const SpellEntry* ability, float& outChance) override { ++counter; return false; }
+            bool OnGossipSelect(Player* player, Creature* creature, uint32 sender, uint32 action, const std::string& code, uint32 gossipListId) override { counter += action; return false; }
+            void OnSetPower(Unit* unit, uint8 power, uint32& value) override { ++counter; }
+            void OnCast(Spell* spell, Unit* caster, Unit* victim) override { counter += spell->m_spellInfo->Id; }
+            void OnInitialize() override
+            {
+                if (subscribed && filterCreatures)
+                {
+                    RegisterCreatureHook(ModuleHook::OnAddToWorld, { BENCHMARK_DUMMY_ENTRY + index });
+                }
+            }
+
+            void OnAddToWorld(Creature* creature) override { ++counter; }
+            void OnDeferredEvents(ModuleHook hook, const std::vector<ModuleEvent>& events) override
+            {
+                for (const ModuleEvent& event : events)
+                {
+                    counter += event.amount;
+                }
+            }
+            void OnSaveToDB(Player* player, ModuleTransaction& transaction) override
+            {
+                transaction.PExecute("REPLACE INTO custom_%s_character (guid, counter) VALUES ('%u', '%llu')", commandPrefix.c_str(), 1U, (unsigned long long)counter);
+            }
+
+            const char* GetChatCommandPrefix() const override { return commandPrefix.c_str(); }
+            std::vector<ModuleChatCommand>* GetCommandTable() override { return &commandTable; }
+
+            uint64 GetCounter() const { return counter; }
+            BenchmarkPlayerData* GetPlayerData(const Player* player) const { return playerData.Get(player); }
+
+        private:
+            uint32 index;
+            bool subscribed;
+            std::string commandPrefix;
+            std::vector<ModuleChatCommand> commandTable;
+            uint64 counter;
+            ModulePlayerSlot<BenchmarkPlayerData> playerData;
+        };
+
+        // Distinct classes for the first modules so they can form a compile time module set
+        constexpr uint32 STATIC_BENCHMARK_MODULES = 10;
+
+        template<uint32 N>
+        class StaticBenchmarkModule final : public BenchmarkModule
+        {
+        public:
+            explicit StaticBenchmarkModule(bool subscribed) : BenchmarkModule(N, subscribed) {}
+        };
+
+        template<uint32... N>
+        void AddStaticBenchmarkModules(std::integer_sequence<uint32, N...>)
+        {
+            ((N < options.modules ? (void)new StaticBenchmarkModule<N>(N < options.subscribers) : void()), ...);
+        }
+
+        template<uint32... N>
+        const ModuleStaticHooks* CreateStaticBenchmarkHooks(const std::vector<Module*>& modules, std::integer_sequence<uint32, N...>)
+        {
+            return ModuleStaticSet<StaticBenchmarkModule<N>...>::Create(modules);
+        }
+
+        struct Result
+        {
+            const char* name;
+            uint32 subscribers;
+            double nsPerCall;
+        };
+
+        // Returns the best ns/call out of all the repetitions
+        template<typename Callable>
+        double Measure(Callable&& callable)
+        {
+            double best = 0.0;
+            for (uint32 repetition = 0; repetition < options.repetitions; ++repetition)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                for (uint32 i = 0; i < options.iterations; ++i)
+                {
+                    callable(i);
+                }
+
+                const auto end = std::chrono::steady_clock::now();
+                const double elapsed = std::chrono::duration<double, std::nano>(end - start).count() / options.iterations;
+                if (repetition == 0 || elapsed < best)
+                {
+                    best = elapsed;
+                }
+            }
+
+            return best;
+        }
+
+        // Fills every equipment, inventory, keyring and bank slot, including 16 slot bags
+        class BenchmarkInventory
+        {
+        public:
+            explicit BenchmarkInventory(Player& player)
+            {
+                for (uint32 i = 0; i < 4; ++i)
+                {
+                    prototypes.push_back({ 1000 + i, i, 0, i });
+                }
+
+                // Bank items use their own entry so a search for them has to walk the whole inventory
+                prototypes.push_back({ 2000, 4, 0, 1 });
+
+                const ItemPrototype* bagPrototype = &prototypes[1];
+                const std::pair<uint8, uint8> itemSlots[] = { { EQUIPMENT_SLOT_START, EQUIPMENT_SLOT_END }, { INVENTORY_SLOT_ITEM_START, INVENTORY_SLOT_ITEM_END }, { KEYRING_SLOT_START, KEYRING_SLOT_END }, { BANK_SLOT_ITEM_START, BANK_SLOT_ITEM_END } };
+                const std::pair<uint8, uint8> bagSlots[] = { { INVENTORY_SLOT_BAG_START, INVENTORY_SLOT_BAG_END }, { BANK_SLOT_BAG_START, BANK_SLOT_BAG_END } };
+                uint32 guid = 1;
+                for (const auto& range : itemSlots)
+                {
+                    for (uint8 slot = range.first; slot < range.second; ++slot)
+                    {
+                        const ItemPrototype* prototype = slot >= BANK_SLOT_ITEM_START && slot < BANK_SLOT_ITEM_END ? &prototypes.back() : &prototypes[guid % 4];
+                        Item* item = new Item(ObjectGuid(HIGHGUID_ITEM, guid++), prototype);
+                        player.SetItemByPos(slot, item);
+                        items.emplace_back(item);
+                    }
+                }
+
+                for (const auto& range : bagSlots)
+                {
+                    for (uint8 slot = range.first; slot < range.second; ++slot)
+                    {
+                        Bag* bag = new Bag(ObjectGuid(HIGHGUID_ITEM, guid++), bagPrototype, 16);
+                        for (uint8 bagSlot = 0; bagSlot < 16; ++bagSlot)
+                        {
+                            const ItemPrototype* prototype = &prototypes[guid % 4];
+                            Item* item = new Item(ObjectGuid(HIGHGUID_ITEM, guid++), prototype);
+                            bag->StoreItem(bagSlot, item);
+                            items.emplace_back(item);
+                        }
+
+                        player.SetItemByPos(slot, bag);
+                        items.emplace_back(bag);
+                    }
+                }
+            }
+
+            const std::vector<ItemPrototype>& GetPrototypes() const { return prototypes; }
+
+        private:
+            std::vector<ItemPrototype> prototypes;
+            std::vector<std::unique_ptr<Item>> items;
+        };
+
+        bool ParseOptions(int argc, char** argv)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                const char* arg = argv[i];
+                const bool hasValue = i + 1 < argc;
+                if (!strcmp(arg, "--csv"))
+                {
+                    options.csv = true;
+                }
+                else if (!strcmp(arg, "--modules") && hasValue)
+                {
+                    options.modules = uint32(std::strtoul(argv[++i], nullptr, 10));
+                }
+                else if (!strcmp(arg, "--subscribers") && hasValue)
+                {
+                    options.subscribers = uint32(std::strtoul(argv[++i], nullptr, 10));
+                }
+                else if (!strcmp(arg, "--iterations") && hasValue)
+                {
+                    options.iterations = std::max(1U, uint32(std::strtoul(argv[++i], nullptr, 10)));
+                }
+                else if (!strcmp(arg, "--repetitions") && hasValue)
+                {
+                    options.repetitions = std::max(1U, uint32(std::strtoul(argv[++i], nullptr, 10)));
+                }
+                else
+                {
+                    fprintf(stderr, "Usage: %s [--modules N] [--subscribers N] [--iterations N] [--repetitions N] [--csv]\n", argv[0]);
+                    return false;
+                }
+            }
+
+            options.subscribers = std::min(options.subscribers, options.modules);
+            return true;
+        }
+
+        void PrintResults(const std::vector<Result>& results)
+        {
+            if (options.csv)
+            {
+                printf("benchmark,modules,subscribers,iterations,ns_per_call\n");
+            }
+
+            for (const Result& result : results)
+            {
+                if (options.csv)
+                {
+                    printf("%s,%u,%u,%u,%.3f\n", result.name, options.modules, result.subscribers, options.iterations, result.nsPerCall);
+                }
+                else
+                {
+                    printf("{\"benchmark\":\"%s\",\"modules\":%u,\"subscribers\":%u,\"iterations\":%u,\"ns_per_call\":%.3f}\n", result.name, options.modules, result.subscribers, options.iterations, result.nsPerCall);
+                }
+            }
+        }
+    }
+}
+
+// Replaces the AddModules() generated by the modules CMakeLists.txt
+void AddModules()
+{
+    using namespace cmangos_module::benchmark;
+    AddStaticBenchmarkModules(std::make_integer_sequence<uint32, STATIC_BENCHMARK_MODULES>());
+    for (uint32 i = STATIC_BENCHMARK_MODULES; i < options.modules; ++i)
+    {
+        new BenchmarkModule(i, i < options.subscribers);
+    }
+}
+
+#ifdef MODULES_STATIC_DISPATCH
+// Replaces the GetStaticModuleHooks() generated by the modules CMakeLists.txt
+const cmangos_module::ModuleStaticHooks* GetStaticModuleHooks(const std::vector<cmangos_module::Module*>& modules)
+{
+    using namespace cmangos_module::benchmark;
+    return CreateStaticBenchmarkHooks(modules, std::make_integer_sequence<uint32, STATIC_BENCHMARK_MODULES>());
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    using namespace cmangos_module;
+    using namespace cmangos_module::benchmark;
+
+    if (!ParseOptions(argc, argv))
+    {
+        return 1;
+    }
+
+    sModuleMgr.OnWorldPreInitialized();
+    sModuleMgr.OnWorldInitialized();
+
+    WorldSession session(SEC_PLAYER);
+    ChatHandler chatHandler(&session);
+    Player player(&session);
+    session.SetPlayer(&player);
+
+    Creature creature(ObjectGuid(HIGHGUID_UNIT, 1, 1));
+    Creature victim(ObjectGuid(HIGHGUID_UNIT, 2, 2));
+    player.SetInteractionTargets(&creature, nullptr);
+
+    const ObjectGuid creatureGuid = creature.GetObjectGuid();
+    const std::string gossipCode;
+    const std::string commandPrefix = "bench" + std::to_string(options.modules ? options.modules - 1 : 0);
+    const std::string command = commandPrefix + " command7 1 2";
+    const std::string typedCommand = commandPrefix + " typed give Thrall 25";
+
+    std::vector<Result> results;
+
+    // Builds the player states of the modules
+    sModuleMgr.OnLoadFromDB(&player, nullptr);
+
+    results.push_back({ "OnDealDamage", options.subscribers, Measure([&](uint32 i)
+    {
+        sModuleMgr.OnDealDamage(&player, &victim, 100, i);
+    })});
+
+    // Same notification queued and delivered in batches from the world update
+    results.push_back({ "OnDealHeal.deferred", options.subscribers, Measure([&](uint32 i)
+    {
+        sModuleMgr.OnDealHeal(&player, &victim, i, 100);
+        if ((i & 1023) == 1023)
+            sModuleMgr.OnWorldUpdated(0);
+    })});
+
+    // Spell hook filtered by spell id, for a spell no module handles and for one handled by a module
+    const SpellEntry ignoredSpellInfo = { 133, 3, 4 };
+    const SpellEntry handledSpellInfo = { 10000, 0, 1 };
+    Spell ignoredSpell(&ignoredSpellInfo);
+    Spell handledSpell(&handledSpellInfo);
+
+    results.push_back({ "OnCast.ignored", options.subscribers, Measure([&](uint32 i)
+    {
+        sModuleMgr.OnCast(&ignoredSpell, &player, &victim);
+    })});
+
+    results.push_back({ "OnCast.handled", options.subscribers, Measure([&](uint32 i)
+    {
+        sModuleMgr.OnCast(&handledSpell, &player, &victim);
+    })});
+
+    results.push_back({ "OnCalculateEffectiveCritChance", options.subscribers, Measure([&](uint32 i)
+    {
+        float chance = 5.0f;
+        sModuleMgr.OnCalculateEffectiveCritChance(&player, &victim, BASE_ATTACK, nullptr, chance);
+    })});
+
+    results.push_back({ "OnGossipSelect", options.subscribers, Measure([&](uint32 i)
+    {
+        sModuleMgr.OnGossipSelect(&player, creatureGuid, 0, i, gossipCode, 0);
+    })});
+
+    results.push_back({ "OnExecuteCommand", options.modules ? 1U : 0U, Measure([&](uint32 i)
+    {
+        sModuleMgr.OnExecuteCommand(&chatHandler, command);
+    })});
+
+    results.push_back({ "OnExecuteCommand.typed", options.modules ? 1U : 0U, Measure([&](uint32 i)
+    {
+        sModuleMgr.OnExecuteCommand(&chatHandler, typedCommand);
+    })});
+
+    results.push_back({ "OnSaveToDB", options.subscribers, Measure([&](uint32 i)
+    {
+        sModuleMgr.OnSaveToDB(&player);
+    })});
+
+    BenchmarkInventory inventory(player);
+    uint64 itemCount = 0;
+
+    results.push_back({ "ForEachItem", 0, Measure([&](uint32 i)
+    {
+        helper::ForEachItem(&player, [&itemCount](Item* item) { itemCount += item->GetCount(); });
+    })});
+
+    results.push_back({ "VisitItems", 0, Measure([&](uint32 i)
+    {
+        helper::VisitItems(&player, [&itemCount](Item* item) { itemCount += item->GetCount(); });
+    })});
+
+    results.push_back({ "VisitItems.filtered", 0, Measure([&](uint32 i)
+    {
+        helper::VisitItems(&player, helper::FilterItems(helper::ItemFilter(2, 2), [&itemCount](Item* item) { itemCount += item->GetCount(); }));
+    })});
+
+    const uint32 searchedEntry = inventory.GetPrototypes().back().ItemId;
+    results.push_back({ "VisitItems.find", 0, Measure([&](uint32 i)
+    {
+        itemCount += helper::VisitItems(&player, [&](Item* item) { return item->GetEntry() != searchedEntry; }) ? 0 : 1;
+    })});
+
+    // Hook without subscribers, dispatched directly and through the inline guard used by the core
+    results.push_back({ "OnSetPower", 0, Measure([&](uint32 i)
+    {
+        uint32 value = i;
+        sModuleMgr.OnSetPower(&player, POWER_MANA, value);
+    })});
+
+    results.push_back({ "OnSetPower.guarded", 0, Measure([&](uint32 i)
+    {
+        uint32 value = i;
+        if (sModuleHookActive(OnSetPower))
+            sModuleMgr.OnSetPower(&player, POWER_MANA, value);
+    })});
+
+    // Per player module data kept in a container keyed by guid as the modules used to, and in a player state slot
+    std::unordered_map<uint32, BenchmarkPlayerData> playerDataMap;
+    for (uint32 i = 0; i < 2000; ++i)
+    {
+        playerDataMap[i * 7] = BenchmarkPlayerData();
+    }
+
+    playerDataMap[player.GetObjectGuid().GetCounter()] = BenchmarkPlayerData();
+    results.push_back({ "PlayerData.map", 0, Measure([&](uint32 i)
+    {
+        auto dataIt = playerDataMap.find(player.GetObjectGuid().GetCounter());
+        if (dataIt != playerDataMap.end())
+            dataIt->second.damage += i;
+    })});
+
+    results.push_back({ "PlayerData.slot", 0, Measure([&](uint32 i)
+    {
+        if (BenchmarkPlayerData* data = firstModule ? firstModule->GetPlayerData(&player) : nullptr)
+            data->damage += i;
+    })});
+
+    // Grid load: every spawn of the grid enters the map and goes through OnAddToWorld, first received by
+    // the modules for every creature and then only for their training dummy. The baseline is the grid
+    // load without modules
+    Map gridMap(1, 0);
+    std::vector<std::unique_ptr<Creature>> gridSpawns;
+    for (uint32 i = 1; i <= 2000; ++i)
+    {
+        const uint32 entry = i % 200 ? 100 + i % 50 : BENCHMARK_DUMMY_ENTRY;
+        gridSpawns.push_back(std::make_unique<Creature>(ObjectGuid(HIGHGUID_UNIT, entry, i)));
+        gridSpawns.back()->SetMap(&gridMap);
+        gridSpawns.back()->SetUInt32Value(UNIT_NPC_FLAGS, i % 10 ? UNIT_NPC_FLAG_NONE : UNIT_NPC_FLAG_GOSSIP);
+    }
+
+    const auto gridLoad = [&](uint32 i)
+    {
+        Creature* spawn = gridSpawns[i % gridSpawns.size()].get();
+        gridMap.AddCreature(spawn->GetObjectGuid(), spawn);
+        if (sModuleHookActive(OnAddToWorld))
+            sModuleMgr.OnAddToWorld(spawn);
+    };
+
+    results.push_back({ "GridLoad.baseline", 0, Measure([&](uint32 i)
+    {
+        Creature* spawn = gridSpawns[i % gridSpawns.size()].get();
+        gridMap.AddCreature(spawn->GetObjectGuid(), spawn);
+    })});
+
+    results.push_back({ "GridLoad.unfiltered", options.subscribers, Measure(gridLoad) });
+
+    // The modules declare their filter when initializing, which also rebuilds the dispatch lists
+    filterCreatures = true;
+    sModuleMgr.OnWorldInitialized();
+
+    results.push_back({ "GridLoad.filtered", options.subscribers, Measure(gridLoad) });
+
+    // Per creature module data kept in a global container keyed by guid, and in a creature state
+    Map creatureMap(0, 0);
+    std::vector<std::unique_ptr<Creature>> creatures;
+    for (uint32 i = 1; i <= 2000; ++i)
+    {
+        creatures.push_back(std::make_unique<Creature>(ObjectGuid(HIGHGUID_UNIT, 100 + i % 50, i)));
+        creatures.back()->SetMap(&creatureMap);
+        creatureMap.AddCreature(creatures.back()->GetObjectGuid(), creatures.back().get());
+    }
+
+    std::unordered_map<uint64, BenchmarkCreatureData> creatureDataMap;
+    ModuleCreatureState<BenchmarkCreatureData> creatureData;
+    for (const std::unique_ptr<Creature>& spawn : creatures)
+    {
+        creatureDataMap[spawn->GetObjectGuid().GetRawValue()] = BenchmarkCreatureData();
+        sModuleMgr.OnAddToWorld(spawn.get());
+        creatureData.Get(spawn.get());
+    }
+
+    results.push_back({ "CreatureData.map", 0, Measure([&](uint32 i)
+    {
+        const Creature* spawn = creatures[i % creatures.size()].get();
+        auto dataIt = creatureDataMap.find(spawn->GetObjectGuid().GetRawValue());
+        if (dataIt != creatureDataMap.end())
+            ++dataIt->second.respawns;
+    })});
+
+    results.push_back({ "CreatureData.state", 0, Measure([&](uint32 i)
+    {
+        ++creatureData.Get(creatures[i % creatures.size()].get()).respawns;
+    })});
+
+    sModuleMgr.OnLogOut(&player);
+
+    PrintResults(results);
+    fprintf(stderr, "Visited %llu items\n", (unsigned long long)itemCount);
+    return 0;
+}
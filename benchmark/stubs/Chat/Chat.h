@@ -0,0 +1,22 @@
+#ifndef MODULES_BENCHMARK_STUB_CHAT_H
+#define MODULES_BENCHMARK_STUB_CHAT_H
+
+#include "Platform/Define.h"
+#include "Server/WorldSession.h"
+
+// Minimal stand-in for the core ChatHandler used by the module benchmark
+class ChatHandler
+{
+public:
+    explicit ChatHandler(WorldSession* session) : m_session(session) {}
+
+    WorldSession* GetSession() { return m_session; }
+
+    void SendSysMessage(const char* /*str*/) {}
+    void PSendSysMessage(const char* /*format*/, ...) ATTR_PRINTF(2, 3) {}
+
+private:
+    WorldSession* m_session;
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef MODULES_BENCHMARK_STUB_COMMON_H
+#define MODULES_BENCHMARK_STUB_COMMON_H
+
+#include "Platform/Define.h"
+
+// Minimal stand-in for the core Common.h used by the module benchmark
+
+enum TimeConstants
+{
+    MINUTE          = 60,
+    HOUR            = MINUTE * 60,
+    DAY             = HOUR * 24,
+    WEEK            = DAY * 7,
+    MONTH           = DAY * 30,
+    YEAR            = MONTH * 12,
+    IN_MILLISECONDS = 1000
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef MODULES_BENCHMARK_STUB_CONFIG_H
+#define MODULES_BENCHMARK_STUB_CONFIG_H
+
+#include "Platform/Define.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <unordered_map>
+
+// Minimal stand-in for the core Config parser used by the module benchmark
+class Config
+{
+public:
+    bool SetSource(const std::string& file, const std::string& /*envVarPrefix*/)
+    {
+        m_filename = file;
+        return Reload();
+    }
+
+    bool Reload()
+    {
+        std::ifstream in(m_filename);
+        if (!in)
+            return false;
+
+        m_entries.clear();
+        std::string line;
+        while (std::getline(in, line))
+        {
+            const size_t equals = line.find('=');
+            if (line.empty() || line[0] == '#' || equals == std::string::npos)
+                continue;
+
+            m_entries[Trim(line.substr(0, equals))] = Trim(line.substr(equals + 1));
+        }
+
+        return true;
+    }
+
+    bool IsSet(const std::string& name) const { return m_entries.find(name) != m_entries.end(); }
+
+    std::string GetStringDefault(const std::string& name, const std::string& def = "") const
+    {
+        auto itr = m_entries.find(name);
+        return itr != m_entries.end() ? itr->second : def;
+    }
+
+    bool GetBoolDefault(const std::string& name, bool def) const
+    {
+        auto itr = m_entries.find(name);
+        if (itr == m_entries.end())
+            return def;
+
+        const std::string& value = itr->second;
+        return value == "true" || value == "TRUE" || value == "yes" || value == "YES" || value == "1";
+    }
+
+    int32 GetIntDefault(const std::string& name, int32 def) const
+    {
+        auto itr = m_entries.find(name);
+        return itr != m_entries.end() ? int32(std::strtol(itr->second.c_str(), nullptr, 10)) : def;
+    }
+
+    float GetFloatDefault(const std::string& name, float def) const
+    {
+        auto itr = m_entries.find(name);
+        return itr != m_entries.end() ? std::strtof(itr->second.c_str(), nullptr) : def;
+    }
+
+    const std::string& GetFilename() const { return m_filename; }
+
+private:
+    static std::string Trim(const std::string& str)
+    {
+        const size_t first = str.find_first_not_of(" \t\r\"");
+        if (first == std::string::npos)
+            return std::string();
+
+        const size_t last = str.find_last_not_of(" \t\r\"");
+        return str.substr(first, last - first + 1);
+    }
+
+private:
+    std::string m_filename;
+    std::unordered_map<std::string, std::string> m_entries;
+};
+
+#endif
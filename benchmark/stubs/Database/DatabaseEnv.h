@@ -0,0 +1,108 @@
+#ifndef MODULES_BENCHMARK_STUB_DATABASE_ENV_H
+#define MODULES_BENCHMARK_STUB_DATABASE_ENV_H
+
+#include "Platform/Define.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Minimal stand-in for the core database layer used by the module benchmark.
+// Statements are counted and dropped, queries return no results
+
+class Field
+{
+public:
+    Field() {}
+    explicit Field(const std::string& value) : m_value(value) {}
+
+    const char* GetString() const { return m_value.c_str(); }
+    std::string GetCppString() const { return m_value; }
+    float GetFloat() const { return std::strtof(m_value.c_str(), nullptr); }
+    bool GetBool() const { return GetInt32() != 0; }
+    int32 GetInt32() const { return int32(std::strtol(m_value.c_str(), nullptr, 10)); }
+    uint8 GetUInt8() const { return uint8(GetUInt32()); }
+    uint16 GetUInt16() const { return uint16(GetUInt32()); }
+    uint32 GetUInt32() const { return uint32(std::strtoul(m_value.c_str(), nullptr, 10)); }
+    uint64 GetUInt64() const { return uint64(std::strtoull(m_value.c_str(), nullptr, 10)); }
+
+private:
+    std::string m_value;
+};
+
+class QueryResult
+{
+public:
+    QueryResult(std::vector<std::vector<Field>> rows, uint32 fieldCount) : m_rows(std::move(rows)), m_fieldCount(fieldCount), m_row(0) {}
+
+    bool NextRow() { return ++m_row < m_rows.size(); }
+    Field* Fetch() { return m_rows[m_row].data(); }
+    uint32 GetFieldCount() const { return m_fieldCount; }
+    uint64 GetRowCount() const { return m_rows.size(); }
+
+private:
+    std::vector<std::vector<Field>> m_rows;
+    uint32 m_fieldCount;
+    size_t m_row;
+};
+
+class Database
+{
+public:
+    Database() : m_statements(0), m_transactions(0), m_inTransaction(false) {}
+
+    bool Execute(const char* /*sql*/) { ++m_statements; return true; }
+    bool PExecute(const char* /*format*/, ...) ATTR_PRINTF(2, 3) { ++m_statements; return true; }
+    bool DirectExecute(const char* /*sql*/) { ++m_statements; return true; }
+
+    QueryResult* Query(const char* /*sql*/) { return nullptr; }
+    QueryResult* PQuery(const char* /*format*/, ...) ATTR_PRINTF(2, 3) { return nullptr; }
+
+    bool BeginTransaction() { m_inTransaction = true; return true; }
+    bool CommitTransaction() { m_inTransaction = false; ++m_transactions; return true; }
+    bool RollbackTransaction() { m_inTransaction = false; return true; }
+
+    void escape_string(std::string& /*str*/) {}
+
+    // Benchmark helpers
+    uint64 GetStatementCount() const { return m_statements; }
+    uint64 GetTransactionCount() const { return m_transactions; }
+
+private:
+    uint64 m_statements;
+    uint64 m_transactions;
+    bool m_inTransaction;
+};
+
+// Holder of the queries run together asynchronously (e.g. the login queries)
+class SqlQueryHolder
+{
+public:
+    virtual ~SqlQueryHolder() {}
+
+    void SetSize(size_t size) { m_queries.resize(size); }
+    bool SetQuery(size_t index, const char* sql)
+    {
+        if (index >= m_queries.size())
+            return false;
+
+        m_queries[index].first = sql;
+        return true;
+    }
+
+    // Benchmark helper to fake the result of a query
+    void SetResult(size_t index, std::unique_ptr<QueryResult> result) { m_queries[index].second = std::move(result); }
+    std::unique_ptr<QueryResult> GetResult(size_t index) { return index < m_queries.size() ? std::move(m_queries[index].second) : nullptr; }
+
+private:
+    std::vector<std::pair<std::string, std::unique_ptr<QueryResult>>> m_queries;
+};
+
+typedef Database DatabaseType;
+
+inline DatabaseType WorldDatabase;
+inline DatabaseType CharacterDatabase;
+inline DatabaseType LoginDatabase;
+
+#endif
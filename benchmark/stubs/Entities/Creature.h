@@ -0,0 +1,7 @@
+#ifndef MODULES_BENCHMARK_STUB_CREATURE_H
+#define MODULES_BENCHMARK_STUB_CREATURE_H
+
+// The benchmark stubs define Creature together with the other units
+#include "Entities/Unit.h"
+
+#endif
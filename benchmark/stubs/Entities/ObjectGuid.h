@@ -0,0 +1,66 @@
+#ifndef MODULES_BENCHMARK_STUB_OBJECT_GUID_H
+#define MODULES_BENCHMARK_STUB_OBJECT_GUID_H
+
+#include "Platform/Define.h"
+
+enum HighGuid
+{
+    HIGHGUID_ITEM           = 0x4000,
+    HIGHGUID_CONTAINER      = 0x4000,
+    HIGHGUID_PLAYER         = 0x0000,
+    HIGHGUID_GAMEOBJECT     = 0xF110,
+    HIGHGUID_TRANSPORT      = 0xF120,
+    HIGHGUID_UNIT           = 0xF130,
+    HIGHGUID_PET            = 0xF140,
+    HIGHGUID_DYNAMICOBJECT  = 0xF100,
+    HIGHGUID_CORPSE         = 0xF101,
+};
+
+// Minimal stand-in for the core ObjectGuid used by the module benchmark
+class ObjectGuid
+{
+public:
+    ObjectGuid() : m_guid(0) {}
+    explicit ObjectGuid(uint64 guid) : m_guid(guid) {}
+    ObjectGuid(HighGuid hi, uint32 entry, uint32 counter) : m_guid(counter ? uint64(counter) | (uint64(entry) << 24) | (uint64(hi) << 48) : 0) {}
+    ObjectGuid(HighGuid hi, uint32 counter) : m_guid(counter ? uint64(counter) | (uint64(hi) << 48) : 0) {}
+
+    uint64 GetRawValue() const { return m_guid; }
+    HighGuid GetHigh() const { return HighGuid((m_guid >> 48) & 0x0000FFFF); }
+    uint32 GetEntry() const { return HasEntry() ? uint32((m_guid >> 24) & uint64(0x0000000000FFFFFF)) : 0; }
+    uint32 GetCounter() const { return HasEntry() ? uint32(m_guid & uint64(0x0000000000FFFFFF)) : uint32(m_guid & uint64(0x00000000FFFFFFFF)); }
+
+    bool IsEmpty() const { return m_guid == 0; }
+    bool IsCreature() const { return GetHigh() == HIGHGUID_UNIT; }
+    bool IsPet() const { return GetHigh() == HIGHGUID_PET; }
+    bool IsAnyTypeCreature() const { return IsCreature() || IsPet(); }
+    bool IsPlayer() const { return !IsEmpty() && GetHigh() == HIGHGUID_PLAYER; }
+    bool IsUnit() const { return IsAnyTypeCreature() || IsPlayer(); }
+    bool IsItem() const { return GetHigh() == HIGHGUID_ITEM; }
+    bool IsGameObject() const { return GetHigh() == HIGHGUID_GAMEOBJECT; }
+
+    bool operator!() const { return IsEmpty(); }
+    bool operator==(const ObjectGuid& guid) const { return GetRawValue() == guid.GetRawValue(); }
+    bool operator!=(const ObjectGuid& guid) const { return GetRawValue() != guid.GetRawValue(); }
+    bool operator<(const ObjectGuid& guid) const { return GetRawValue() < guid.GetRawValue(); }
+
+private:
+    bool HasEntry() const
+    {
+        switch (GetHigh())
+        {
+            case HIGHGUID_ITEM:
+            case HIGHGUID_PLAYER:
+            case HIGHGUID_DYNAMICOBJECT:
+            case HIGHGUID_CORPSE:
+                return false;
+            default:
+                return true;
+        }
+    }
+
+private:
+    uint64 m_guid;
+};
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef MODULES_BENCHMARK_STUB_PLAYER_H
+#define MODULES_BENCHMARK_STUB_PLAYER_H
+
+#include "Entities/Unit.h"
+#include "Chat/Chat.h"
+#include "Server/WorldSession.h"
+
+// Minimal stand-in for the core Player and Item classes used by the module benchmark
+
+#define INVENTORY_SLOT_BAG_0    255
+#define MAX_GAMEOBJECT_TYPE     36
+
+enum EquipmentSlots
+{
+    EQUIPMENT_SLOT_START        = 0,
+    EQUIPMENT_SLOT_END          = 19
+};
+
+enum InventorySlots
+{
+    INVENTORY_SLOT_BAG_START    = 19,
+    INVENTORY_SLOT_BAG_END      = 23,
+    INVENTORY_SLOT_ITEM_START   = 23,
+    INVENTORY_SLOT_ITEM_END     = 39
+};
+
+enum BankSlots
+{
+    BANK_SLOT_ITEM_START        = 39,
+    BANK_SLOT_ITEM_END          = 67,
+    BANK_SLOT_BAG_START         = 67,
+    BANK_SLOT_BAG_END           = 74
+};
+
+enum KeyRingSlots
+{
+    KEYRING_SLOT_START          = 86,
+    KEYRING_SLOT_END            = 118
+};
+
+#define PLAYER_SLOT_END 118
+
+// Only the size of the core login query holder is needed
+enum PlayerLoginQueryIndex
+{
+    MAX_PLAYER_LOGIN_QUERY      = 26
+};
+
+enum Races
+{
+    RACE_HUMAN      = 1,
+    RACE_ORC        = 2,
+    RACE_DWARF      = 3,
+    RACE_NIGHTELF   = 4,
+    RACE_UNDEAD     = 5,
+    RACE_TAUREN     = 6,
+    RACE_GNOME      = 7,
+    RACE_TROLL      = 8,
+    RACE_BLOODELF   = 10,
+    RACE_DRAENEI    = 11
+};
+
+struct ItemPrototype
+{
+    uint32 ItemId;
+    uint32 Class;
+    uint32 SubClass;
+    uint32 Quality;
+};
+
+class Item : public Object
+{
+public:
+    Item(const ObjectGuid& guid, const ItemPrototype* proto, uint32 count = 1) : Object(guid), m_proto(proto), m_count(count) {}
+
+    const ItemPrototype* GetProto() const { return m_proto; }
+    uint32 GetEntry() const { return m_proto ? m_proto->ItemId : 0; }
+    uint32 GetCount() const { return m_count; }
+    virtual bool IsBag() const { return false; }
+
+private:
+    const ItemPrototype* m_proto;
+    uint32 m_count;
+};
+
+class Bag : public Item
+{
+public:
+    Bag(const ObjectGuid& guid, const ItemPrototype* proto, uint32 size) : Item(guid, proto), m_slots(size, nullptr) {}
+
+    bool IsBag() const override { return true; }
+    uint32 GetBagSize() const { return uint32(m_slots.size()); }
+    Item* GetItemByPos(uint8 slot) const { return slot < m_slots.size() ? m_slots[slot] : nullptr; }
+    void StoreItem(uint8 slot, Item* item) { if (slot < m_slots.size()) m_slots[slot] = item; }
+
+private:
+    std::vector<Item*> m_slots;
+};
+
+class Player : public Unit
+{
+public:
+    explicit Player(WorldSession* session = nullptr, const ObjectGuid& guid = ObjectGuid(HIGHGUID_PLAYER, 1))
+    : Unit(guid), m_session(session), m_race(RACE_HUMAN), m_items(), m_interactCreature(nullptr), m_interactGameObject(nullptr), m_moduleStateIndex(0) {}
+
+    WorldSession* GetSession() const { return m_session; }
+    uint8 getRace() const { return m_race; }
+    bool InBattleGround() const { return false; }
+    bool InArena() const { return false; }
+    bool IsBeingTeleported() const { return false; }
+
+    uint32 GetModuleStateIndex() const { return m_moduleStateIndex; }
+    void SetModuleStateIndex(uint32 index) { m_moduleStateIndex = index; }
+
+    Item* GetItemByPos(uint8 bag, uint8 slot) const
+    {
+        if (bag == INVENTORY_SLOT_BAG_0)
+            return slot < PLAYER_SLOT_END ? m_items[slot] : nullptr;
+
+        if (Item* bagItem = GetItemByPos(INVENTORY_SLOT_BAG_0, bag))
+            return bagItem->IsBag() ? static_cast<Bag*>(bagItem)->GetItemByPos(slot) : nullptr;
+
+        return nullptr;
+    }
+
+    Item* GetItemByGuid(ObjectGuid guid) const
+    {
+        for (Item* item : m_items)
+        {
+            if (item && item->GetObjectGuid() == guid)
+                return item;
+
+            if (item && item->IsBag())
+            {
+                const Bag* bag = static_cast<const Bag*>(item);
+                for (uint32 i = 0; i < bag->GetBagSize(); ++i)
+                {
+                    Item* bagItem = bag->GetItemByPos(uint8(i));
+                    if (bagItem && bagItem->GetObjectGuid() == guid)
+                        return bagItem;
+                }
+            }
+        }
+
+        return nullptr;
+    }
+
+    Creature* GetNPCIfCanInteractWith(ObjectGuid guid, uint32 /*npcflagmask*/)
+    {
+        return m_interactCreature && m_interactCreature->GetObjectGuid() == guid ? m_interactCreature : nullptr;
+    }
+
+    GameObject* GetGameObjectIfCanInteractWith(ObjectGuid guid, uint32 /*gameobject_type*/ = MAX_GAMEOBJECT_TYPE) const
+    {
+        return m_interactGameObject && m_interactGameObject->GetObjectGuid() == guid ? m_interactGameObject : nullptr;
+    }
+
+    // Benchmark setup helpers
+    void SetItemByPos(uint8 slot, Item* item) { if (slot < PLAYER_SLOT_END) m_items[slot] = item; }
+    void SetInteractionTargets(Creature* creature, GameObject* gameObject) { m_interactCreature = creature; m_interactGameObject = gameObject; }
+
+private:
+    WorldSession* m_session;
+    uint8 m_race;
+    std::array<Item*, PLAYER_SLOT_END> m_items;
+    Creature* m_interactCreature;
+    GameObject* m_interactGameObject;
+    uint32 m_moduleStateIndex;
+};
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef MODULES_BENCHMARK_STUB_UNIT_H
+#define MODULES_BENCHMARK_STUB_UNIT_H
+
+#include "Common.h"
+#include "Platform/Define.h"
+#include "Policies/Singleton.h"
+#include "Entities/ObjectGuid.h"
+
+#include <array>
+#include <unordered_map>
+
+// Minimal stand-in for the core entity hierarchy used by the module benchmark
+
+#define NUM_SPELL_PARTIAL_RESISTS 5
+
+enum ReputationRank
+{
+    REP_HATED       = 0,
+    REP_HOSTILE     = 1,
+    REP_UNFRIENDLY  = 2,
+    REP_NEUTRAL     = 3,
+    REP_FRIENDLY    = 4,
+    REP_HONORED     = 5,
+    REP_REVERED     = 6,
+    REP_EXALTED     = 7
+};
+
+enum SpellAuraProcResult
+{
+    SPELL_AURA_PROC_OK              = 0,
+    SPELL_AURA_PROC_FAILED          = 1,
+    SPELL_AURA_PROC_CANT_TRIGGER    = 2
+};
+
+enum WeaponAttackType
+{
+    BASE_ATTACK   = 0,
+    OFF_ATTACK    = 1,
+    RANGED_ATTACK = 2
+};
+
+enum NPCFlags
+{
+    UNIT_NPC_FLAG_NONE      = 0x00000000,
+    UNIT_NPC_FLAG_GOSSIP    = 0x00000001,
+    UNIT_NPC_FLAG_VENDOR    = 0x00000004,
+    UNIT_NPC_FLAG_TRAINER   = 0x00000010
+};
+
+enum EUnitFields
+{
+    UNIT_NPC_FLAGS = 0x0093
+};
+
+enum Powers
+{
+    POWER_MANA      = 0,
+    POWER_RAGE      = 1,
+    POWER_FOCUS     = 2,
+    POWER_ENERGY    = 3,
+    POWER_HAPPINESS = 4
+};
+
+class Aura;
+class Creature;
+class Group;
+class WorldSession;
+
+struct SpellEntry
+{
+    uint32 Id;
+    uint32 SpellFamilyName;
+    uint32 SchoolMask;
+};
+
+class Object
+{
+public:
+    explicit Object(const ObjectGuid& guid = ObjectGuid()) : m_guid(guid) {}
+    virtual ~Object() {}
+
+    const ObjectGuid& GetObjectGuid() const { return m_guid; }
+    uint32 GetEntry() const { return m_guid.GetEntry(); }
+    bool IsInWorld() const { return true; }
+
+    uint32 GetUInt32Value(uint16 index) const { return m_values[index]; }
+    void SetUInt32Value(uint16 index, uint32 value) { m_values[index] = value; }
+
+private:
+    ObjectGuid m_guid;
+    std::array<uint32, UNIT_NPC_FLAGS + 1> m_values = {};
+};
+
+class Map
+{
+public:
+    explicit Map(uint32 id = 0, uint32 instanceId = 0) : m_id(id), m_instanceId(instanceId) {}
+
+    uint32 GetId() const { return m_id; }
+    uint32 GetInstanceId() const { return m_instanceId; }
+    bool IsDungeon() const { return m_instanceId != 0; }
+    bool IsRaid() const { return false; }
+
+    Creature* GetAnyTypeCreature(ObjectGuid guid)
+    {
+        auto creatureIt = m_creatures.find(guid.GetRawValue());
+        return creatureIt != m_creatures.end() ? creatureIt->second : nullptr;
+    }
+
+    // Benchmark setup helpers
+    void AddCreature(ObjectGuid guid, Creature* creature) { m_creatures[guid.GetRawValue()] = creature; }
+    void RemoveCreature(ObjectGuid guid) { m_creatures.erase(guid.GetRawValue()); }
+
+private:
+    uint32 m_id;
+    uint32 m_instanceId;
+    std::unordered_map<uint64, Creature*> m_creatures;
+};
+
+class WorldObject : public Object
+{
+public:
+    explicit WorldObject(const ObjectGuid& guid = ObjectGuid()) : Object(guid), m_map(nullptr) {}
+
+    Map* GetMap() const { return m_map; }
+    void SetMap(Map* map) { m_map = map; }
+
+private:
+    Map* m_map;
+};
+
+class Unit : public WorldObject
+{
+public:
+    explicit Unit(const ObjectGuid& guid = ObjectGuid()) : WorldObject(guid), m_level(1) {}
+
+    uint32 GetLevel() const { return m_level; }
+    void SetLevel(uint32 level) { m_level = level; }
+
+private:
+    uint32 m_level;
+};
+
+class Creature : public Unit
+{
+public:
+    explicit Creature(const ObjectGuid& guid = ObjectGuid()) : Unit(guid) {}
+};
+
+class GameObject : public WorldObject
+{
+public:
+    explicit GameObject(const ObjectGuid& guid = ObjectGuid()) : WorldObject(guid) {}
+};
+
+class Spell
+{
+public:
+    explicit Spell(const SpellEntry* spellInfo = nullptr) : m_spellInfo(spellInfo) {}
+
+    const SpellEntry* m_spellInfo;
+};
+
+class Aura
+{
+public:
+    explicit Aura(const SpellEntry* spellProto = nullptr) : m_spellProto(spellProto) {}
+
+    const SpellEntry* GetSpellProto() const { return m_spellProto; }
+
+private:
+    const SpellEntry* m_spellProto;
+};
+
+struct ProcExecutionData
+{
+    Aura* triggeredByAura = nullptr;
+    const SpellEntry* spellInfo = nullptr;
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef MODULES_BENCHMARK_STUB_LOG_H
+#define MODULES_BENCHMARK_STUB_LOG_H
+
+#include "Platform/Define.h"
+#include "Policies/Singleton.h"
+
+// Minimal stand-in for the core logger used by the module benchmark (writes to stderr)
+class Log
+{
+public:
+    void outString(const char* str, ...) ATTR_PRINTF(2, 3)
+    {
+        va_list ap;
+        va_start(ap, str);
+        vfprintf(stderr, str, ap);
+        va_end(ap);
+        fputc('\n', stderr);
+    }
+
+    void outError(const char* err, ...) ATTR_PRINTF(2, 3)
+    {
+        va_list ap;
+        va_start(ap, err);
+        vfprintf(stderr, err, ap);
+        va_end(ap);
+        fputc('\n', stderr);
+    }
+};
+
+#define sLog MaNGOS::Singleton<Log>::Instance()
+
+#endif
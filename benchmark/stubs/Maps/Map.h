@@ -0,0 +1,7 @@
+#ifndef MODULES_BENCHMARK_STUB_MAP_H
+#define MODULES_BENCHMARK_STUB_MAP_H
+
+// The benchmark stubs define Map together with the entities
+#include "Entities/Unit.h"
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef MODULES_BENCHMARK_STUB_MAP_MANAGER_H
+#define MODULES_BENCHMARK_STUB_MAP_MANAGER_H
+
+#include "Maps/Map.h"
+#include "Policies/Singleton.h"
+
+#include <unordered_map>
+
+// Minimal stand-in for the core MapManager used by the module benchmark
+class MapManager : public MaNGOS::Singleton<MapManager>
+{
+public:
+    Map* FindMap(uint32 mapId, uint32 instanceId = 0) const
+    {
+        auto mapIt = m_maps.find((uint64(instanceId) << 32) | mapId);
+        return mapIt != m_maps.end() ? mapIt->second : nullptr;
+    }
+
+    // Benchmark setup helpers
+    void AddMap(Map* map) { m_maps[(uint64(map->GetInstanceId()) << 32) | map->GetId()] = map; }
+    void RemoveMap(Map* map) { m_maps.erase((uint64(map->GetInstanceId()) << 32) | map->GetId()); }
+
+private:
+    std::unordered_map<uint64, Map*> m_maps;
+};
+
+#define sMapMgr MapManager::Instance()
+
+#endif
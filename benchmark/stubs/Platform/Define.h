@@ -0,0 +1,36 @@
+#ifndef MODULES_BENCHMARK_STUB_DEFINE_H
+#define MODULES_BENCHMARK_STUB_DEFINE_H
+
+// Minimal stand-in for the core Platform/Define.h used by the module benchmark
+
+#include <array>
+#include <cctype>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef std::int64_t int64;
+typedef std::int32_t int32;
+typedef std::int16_t int16;
+typedef std::int8_t int8;
+typedef std::uint64_t uint64;
+typedef std::uint32_t uint32;
+typedef std::uint16_t uint16;
+typedef std::uint8_t uint8;
+
+#if defined(__GNUC__)
+#  define ATTR_PRINTF(F, V) __attribute__ ((format (printf, F, V)))
+#else
+#  define ATTR_PRINTF(F, V)
+#endif
+
+#ifndef EXPANSION
+#  define EXPANSION 1
+#endif
+
+#endif
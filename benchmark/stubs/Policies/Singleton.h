@@ -0,0 +1,22 @@
+#ifndef MODULES_BENCHMARK_STUB_SINGLETON_H
+#define MODULES_BENCHMARK_STUB_SINGLETON_H
+
+// Minimal stand-in for the core MaNGOS::Singleton used by the module benchmark
+
+namespace MaNGOS
+{
+    template<typename T>
+    class Singleton
+    {
+    public:
+        static T& Instance()
+        {
+            static T instance;
+            return instance;
+        }
+    };
+}
+
+#define INSTANTIATE_SINGLETON_1(TYPE) template class MaNGOS::Singleton<TYPE>
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef MODULES_BENCHMARK_STUB_WORLD_SESSION_H
+#define MODULES_BENCHMARK_STUB_WORLD_SESSION_H
+
+#include "Platform/Define.h"
+
+// Minimal stand-in for the core WorldSession used by the module benchmark
+
+enum AccountTypes
+{
+    SEC_PLAYER          = 0,
+    SEC_MODERATOR       = 1,
+    SEC_GAMEMASTER      = 2,
+    SEC_ADMINISTRATOR   = 3,
+    SEC_CONSOLE         = 4
+};
+
+class Player;
+
+class WorldSession
+{
+public:
+    explicit WorldSession(AccountTypes security = SEC_PLAYER) : m_security(security), m_player(nullptr) {}
+
+    AccountTypes GetSecurity() const { return m_security; }
+    Player* GetPlayer() const { return m_player; }
+    void SetPlayer(Player* player) { m_player = player; }
+
+private:
+    AccountTypes m_security;
+    Player* m_player;
+};
+
+#endif
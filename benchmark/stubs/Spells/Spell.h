@@ -0,0 +1,7 @@
+#ifndef MODULES_BENCHMARK_STUB_SPELL_H
+#define MODULES_BENCHMARK_STUB_SPELL_H
+
+// The benchmark stubs define Spell together with the entities
+#include "Entities/Unit.h"
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef MODULES_BENCHMARK_STUB_SPELL_AURAS_H
+#define MODULES_BENCHMARK_STUB_SPELL_AURAS_H
+
+// The benchmark stubs define Aura together with the entities
+#include "Entities/Unit.h"
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef MODULES_BENCHMARK_STUB_SYSTEM_CONFIG_H
+#define MODULES_BENCHMARK_STUB_SYSTEM_CONFIG_H
+
+#define SYSCONFDIR ""
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef MODULES_BENCHMARK_STUB_WORLD_H
+#define MODULES_BENCHMARK_STUB_WORLD_H
+
+#include "Platform/Define.h"
+#include "Log/Log.h"
+#include "Policies/Singleton.h"
+
+// Minimal stand-in for the core World used by the module benchmark
+
+enum eConfigUInt32Values
+{
+    CONFIG_UINT32_MAX_PLAYER_LEVEL = 0,
+    CONFIG_UINT32_VALUE_COUNT
+};
+
+class World
+{
+public:
+    World() : m_configUint32Values() { m_configUint32Values[CONFIG_UINT32_MAX_PLAYER_LEVEL] = 70; }
+
+    uint32 getConfig(eConfigUInt32Values index) const { return m_configUint32Values[index]; }
+
+private:
+    uint32 m_configUint32Values[CONFIG_UINT32_VALUE_COUNT];
+};
+
+#define sWorld MaNGOS::Singleton<World>::Instance()
+
+#endif
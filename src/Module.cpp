@@ -1,16 +1,39 @@
 #include "Module.h"
 #include "ModuleMgr.h"
 #include "ModuleConfig.h"
+#include "ModuleItemVisitor.h"
 
 #include "Entities/Player.h"
 #include "World/World.h"
 
+#include <cstdarg>
+#include <cstdio>
+
 namespace cmangos_module
 {
     namespace helper
     {
+        namespace
+        {
+            void AppendFormatV(std::string& out, const char* format, va_list ap)
+            {
+                va_list apCopy;
+                va_copy(apCopy, ap);
+                const int length = vsnprintf(nullptr, 0, format, apCopy);
+                va_end(apCopy);
+
+                if (length > 0)
+                {
+                    // vsnprintf needs room for the null terminator
+                    const size_t offset = out.size();
+                    out.resize(offset + length + 1);
+                    vsnprintf(&out[offset], length + 1, format, ap);
+                    out.resize(offset + length);
+                }
+            }
+        }
 
-        bool IsValidNumberString(const std::string& str)
+        bool IsValidNumberString(std::string_view str)
         {
             bool valid = !str.empty();
             if (valid)
@@ -20,12 +43,13 @@ namespace cmangos_module
                 if (str[0] == '+' || str[0] == '-')
                 {
                     start = 1;
+                    valid = str.size() > 1;
                 }
 
                 // Loop through each character to check if it's a digit
                 for (size_t i = start; i < str.size(); ++i)
                 {
-                    if (!std::isdigit(str[i]))
+                    if (!std::isdigit(static_cast<unsigned char>(str[i])))
                     {
                         // Non-numeric character found
                         valid = false;
@@ -39,28 +63,72 @@ namespace cmangos_module
 
         std::string FormatString(const char* format, ...)
         {
+            std::string out;
             va_list ap;
-            char out[2048];
             va_start(ap, format);
-            vsnprintf(out, 2048, format, ap);
+            AppendFormatV(out, format, ap);
+            va_end(ap);
+            return out;
+        }
+
+        size_t FormatStringTo(char* buffer, size_t size, const char* format, ...)
+        {
+            va_list ap;
+            va_start(ap, format);
+            const int length = vsnprintf(buffer, size, format, ap);
+            va_end(ap);
+            return length > 0 ? static_cast<size_t>(length) : 0;
+        }
+
+        void AppendFormat(std::string& out, const char* format, ...)
+        {
+            va_list ap;
+            va_start(ap, format);
+            AppendFormatV(out, format, ap);
             va_end(ap);
-            return std::string(out);
         }
 
         std::vector<std::string> SplitString(const std::string& input, const std::string& delimiter)
         {
             std::vector<std::string> substrings;
-            size_t start = 0, end;
+            StringTokenizer tokenizer(input, delimiter, false);
+            std::string_view token;
+            while (tokenizer.Next(token))
+            {
+                substrings.emplace_back(token);
+            }
 
-            while ((end = input.find(delimiter, start)) != std::string::npos)
+            return substrings;
+        }
+
+        void SplitString(std::string_view input, std::string_view delimiter, std::vector<std::string_view>& tokens)
+        {
+            tokens.clear();
+            StringTokenizer tokenizer(input, delimiter, false);
+            std::string_view token;
+            while (tokenizer.Next(token))
             {
-                substrings.push_back(input.substr(start, end - start));
-                start = end + delimiter.length();
+                tokens.push_back(token);
             }
+        }
+
+        bool StringTokenizer::Next(std::string_view& token)
+        {
+            while (position <= input.size())
+            {
+                // An empty delimiter returns the whole input as a single token
+                const size_t end = delimiter.empty() ? std::string_view::npos : input.find(delimiter, position);
+                const size_t tokenEnd = end != std::string_view::npos ? end : input.size();
+                token = input.substr(position, tokenEnd - position);
+                position = end != std::string_view::npos ? end + delimiter.size() : input.size() + 1;
 
-            substrings.push_back(input.substr(start)); // Add the last substring
+                if (!skipEmpty || !token.empty())
+                {
+                    return true;
+                }
+            }
 
-            return substrings;
+            return false;
         }
 
         bool IsMaxLevel(const Player* player)
@@ -132,89 +200,80 @@ namespace cmangos_module
             return false;
         }
 
-        void ForEachItemInternal(const Player* player, uint8 start, uint8 end, std::function<void(Item*)> callback)
-        {
-            if (player)
-            {
-                for (uint8 i = start; i < end; ++i)
-                {
-                    if (start == INVENTORY_SLOT_BAG_START || start == BANK_SLOT_BAG_START)
-                    {
-                        if (Bag* bag = (Bag*)player->GetItemByPos(INVENTORY_SLOT_BAG_0, i))
-                        {
-                            for (uint32 j = 0; j < bag->GetBagSize(); ++j)
-                            {
-                                if (Item* item = bag->GetItemByPos(j))
-                                {
-                                    callback(item);
-                                }
-                            }
-                        }
-                    }
-                    else
-                    {
-                        if (Item* item = player->GetItemByPos(INVENTORY_SLOT_BAG_0, i))
-                        {
-                            callback(item);
-                        }
-                    }
-                }
-            }
-        }
-
         void ForEachEquippedItem(const Player* player, std::function<void(Item*)> callback)
         {
-            ForEachItemInternal(player, EQUIPMENT_SLOT_START, EQUIPMENT_SLOT_END, callback);
+            VisitEquippedItems(player, callback);
         }
 
         void ForEachInventoryItem(const Player* player, std::function<void(Item*)> callback)
         {
-            ForEachItemInternal(player, INVENTORY_SLOT_ITEM_START, INVENTORY_SLOT_ITEM_END, callback);
-            ForEachItemInternal(player, INVENTORY_SLOT_BAG_START, INVENTORY_SLOT_BAG_END, callback);
+            VisitInventoryItems(player, callback);
         }
 
         void ForEachKeyItem(const Player* player, std::function<void(Item*)> callback)
         {
-            ForEachItemInternal(player, KEYRING_SLOT_START, KEYRING_SLOT_END, callback);
+            VisitKeyItems(player, callback);
         }
 
         void ForEachBankItem(const Player* player, std::function<void(Item*)> callback)
         {
-            ForEachItemInternal(player, BANK_SLOT_ITEM_START, BANK_SLOT_ITEM_END, callback);
-            ForEachItemInternal(player, BANK_SLOT_BAG_START, BANK_SLOT_BAG_END, callback);
+            VisitBankItems(player, callback);
         }
 
         void ForEachItem(const Player* player, std::function<void(Item*)> callback)
         {
-            ForEachEquippedItem(player, callback);
-            ForEachInventoryItem(player, callback);
-            ForEachKeyItem(player, callback);
-            ForEachBankItem(player, callback);
+            VisitItems(player, callback);
         }
     }
 
     Module::Module(const std::string& name, ModuleConfig* config)
     : config(config)
     , name(name)
+    , declaredHooks(false)
+    , id(0)
     {
         sModuleMgr.RegisterModule(this);
     }
 
     Module::~Module()
     {
-        if (config)
+        delete config.exchange(nullptr);
+    }
+
+    void Module::LoadConfig()
+    {
+        if (ModuleConfig* currentConfig = config.load())
         {
-            delete config;
-            config = nullptr;
+            currentConfig->Load();
         }
     }
 
-    void Module::LoadConfig()
+    bool Module::ReloadConfig()
     {
-        if (config)
+        const ModuleConfig* currentConfig = config.load();
+        if (!currentConfig)
         {
-            config->Load();
+            return false;
         }
+
+        ModuleConfig* snapshot = currentConfig->CreateSnapshot();
+        if (!snapshot)
+        {
+            sLog.outError("Module %s doesn't support reloading its configuration", name.c_str());
+            return false;
+        }
+
+        // Keep using the current config if the new one fails to load
+        if (!snapshot->Load())
+        {
+            delete snapshot;
+            return false;
+        }
+
+        sModuleMgr.RetireConfig(config.exchange(snapshot, std::memory_order_acq_rel));
+        sLog.outString("Reloaded %s module configuration", name.c_str());
+        OnConfigReloaded();
+        return true;
     }
 
     void Module::Initialize()
@@ -222,4 +281,164 @@ namespace cmangos_module
         sLog.outString("Initializing %s module", name.c_str());
         OnInitialize();
     }
+
+    void Module::RegisterHook(ModuleHook hook)
+    {
+        if (hook != ModuleHook::MAX)
+        {
+            hooks.set(static_cast<size_t>(hook));
+            declaredHooks = true;
+        }
+    }
+
+    void Module::RegisterHooks(std::initializer_list<ModuleHook> hookList)
+    {
+        for (ModuleHook hook : hookList)
+        {
+            RegisterHook(hook);
+        }
+    }
+
+    void Module::RegisterHook(ModuleHook hook, int32 priority)
+    {
+        if (hook != ModuleHook::MAX)
+        {
+            RegisterHook(hook);
+            hookPriorities[hook] = priority;
+        }
+    }
+
+    void Module::RegisterDeferredHook(ModuleHook hook)
+    {
+        if (IsModuleEventHook(hook))
+        {
+            deferredHooks.set(static_cast<size_t>(hook));
+            declaredHooks = true;
+        }
+        else if (hook != ModuleHook::MAX)
+        {
+            sLog.outError("Module %s: hook %s can't be deferred", name.c_str(), GetModuleHookName(hook));
+        }
+    }
+
+    void Module::RegisterSpellHook(ModuleHook hook, const std::vector<uint32>& spellIds)
+    {
+        if (!IsModuleSpellHook(hook))
+        {
+            sLog.outError("Module %s: hook %s can't be filtered by spell", name.c_str(), GetModuleHookName(hook));
+            return;
+        }
+
+        RegisterHook(hook);
+        ModuleSpellFilter& filter = spellFilters[hook];
+        for (uint32 spellId : spellIds)
+        {
+            filter.AddSpell(spellId);
+        }
+    }
+
+    void Module::RegisterSpellFamilyHook(ModuleHook hook, const std::vector<uint32>& spellFamilies)
+    {
+        if (!IsModuleSpellHook(hook))
+        {
+            sLog.outError("Module %s: hook %s can't be filtered by spell", name.c_str(), GetModuleHookName(hook));
+            return;
+        }
+
+        RegisterHook(hook);
+        ModuleSpellFilter& filter = spellFilters[hook];
+        for (uint32 family : spellFamilies)
+        {
+            filter.AddFamily(family);
+        }
+    }
+
+    void Module::RegisterCreatureHook(ModuleHook hook, const std::vector<uint32>& entries)
+    {
+        if (!IsModuleCreatureHook(hook))
+        {
+            sLog.outError("Module %s: hook %s can't be filtered by creature", name.c_str(), GetModuleHookName(hook));
+            return;
+        }
+
+        RegisterHook(hook);
+        ModuleCreatureFilter& filter = creatureFilters[hook];
+        for (uint32 entry : entries)
+        {
+            filter.AddEntry(entry);
+        }
+    }
+
+    void Module::RegisterCreatureNpcFlagHook(ModuleHook hook, uint32 npcFlags)
+    {
+        if (!IsModuleCreatureHook(hook))
+        {
+            sLog.outError("Module %s: hook %s can't be filtered by creature", name.c_str(), GetModuleHookName(hook));
+            return;
+        }
+
+        RegisterHook(hook);
+        creatureFilters[hook].AddNpcFlags(npcFlags);
+    }
+
+    void Module::UseChanceCache(ModuleHook hook)
+    {
+        if (!IsModuleChanceHook(hook))
+        {
+            sLog.outError("Module %s: hook %s can't use the chance cache", name.c_str(), GetModuleHookName(hook));
+            return;
+        }
+
+        RegisterHook(hook);
+        chanceCachedHooks.set(static_cast<size_t>(hook));
+        sModuleMgr.EnableChanceCache();
+    }
+
+    const ModuleSpellFilter* Module::GetSpellFilter(ModuleHook hook) const
+    {
+        auto filterIt = spellFilters.find(hook);
+        return filterIt != spellFilters.end() ? &filterIt->second : nullptr;
+    }
+
+    const ModuleCreatureFilter* Module::GetCreatureFilter(ModuleHook hook) const
+    {
+        auto filterIt = creatureFilters.find(hook);
+        return filterIt != creatureFilters.end() ? &filterIt->second : nullptr;
+    }
+
+    int32 Module::GetHookPriority(ModuleHook hook) const
+    {
+        auto priorityIt = hookPriorities.find(hook);
+        return priorityIt != hookPriorities.end() ? priorityIt->second : 0;
+    }
+
+    uint32 Module::RegisterTask(const std::string& taskName, uint32 interval, ModuleTaskCost cost, ModuleTaskCallback callback)
+    {
+        return sModuleMgr.RegisterTask(this, taskName, interval, cost, std::move(callback));
+    }
+
+    void Module::RemoveTask(uint32 taskId)
+    {
+        sModuleMgr.RemoveTask(taskId);
+    }
+
+    uint32 Module::RegisterCharacterQuery(const std::string& query)
+    {
+        return sModuleMgr.RegisterCharacterQuery(this, query);
+    }
+
+    void Module::UseInventoryIndex()
+    {
+        sModuleMgr.EnableInventoryIndex();
+    }
+
+    const ModuleInventoryIndex* Module::GetInventoryIndex(const Player* player) const
+    {
+        return sModuleMgr.GetInventoryIndex(player);
+    }
+
+    const ModulePlayerStates* Module::RegisterPlayerState(uint32 size, uint32 alignment, ModulePlayerStates::Constructor constructor, ModulePlayerStates::Destructor destructor, uint32& outOffset)
+    {
+        return sModuleMgr.RegisterPlayerState(this, size, alignment, constructor, destructor, outOffset);
+    }
 }
\ No newline at end of file
@@ -3,9 +3,27 @@
 
 #include "Platform/Define.h"
 #include "Entities/Unit.h"
-
+#include "ModuleAttackTable.h"
+#include "ModuleChanceCache.h"
+#include "ModuleCommand.h"
+#include "ModuleCreatureFilter.h"
+#include "ModuleEvent.h"
+#include "ModuleHook.h"
+#include "ModuleInventoryIndex.h"
+#include "ModulePlayerState.h"
+#include "ModuleQuery.h"
+#include "ModuleScheduler.h"
+#include "ModuleSpellFilter.h"
+#include "ModuleTransaction.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <initializer_list>
 #include <map>
 #include <string>
+#include <string_view>
 
 class BattleGround;
 class BattleGroundWS;
@@ -46,9 +64,38 @@ namespace cmangos_module
 {
     namespace helper
     {
-        bool IsValidNumberString(const std::string& str);
-        std::string FormatString(const char* format, ...);
+        bool IsValidNumberString(std::string_view str);
+
+        // Formats into a new string of the required size (the format gets checked at compile time)
+        std::string FormatString(const char* format, ...) ATTR_PRINTF(1, 2);
+        // Formats into the given buffer, truncating if needed. Returns the length the full output
+        // would have (like snprintf) so the caller can detect the truncation
+        size_t FormatStringTo(char* buffer, size_t size, const char* format, ...) ATTR_PRINTF(3, 4);
+        // Appends the formatted output to the given string, reusing its capacity
+        void AppendFormat(std::string& out, const char* format, ...) ATTR_PRINTF(2, 3);
+
         std::vector<std::string> SplitString(const std::string& input, const std::string& delimiter);
+        // Fills the given vector (reusing its capacity) with views into the input
+        void SplitString(std::string_view input, std::string_view delimiter, std::vector<std::string_view>& tokens);
+
+        // Iterates the tokens of a string without allocating, e.g.
+        // StringTokenizer tokenizer(args, " "); std::string_view token; while (tokenizer.Next(token)) { ... }
+        class StringTokenizer
+        {
+        public:
+            StringTokenizer(std::string_view input, std::string_view delimiter, bool skipEmpty = true)
+            : input(input), delimiter(delimiter), position(0), skipEmpty(skipEmpty) {}
+
+            bool Next(std::string_view& token);
+            // Remaining input after the last token returned
+            std::string_view GetRemaining() const { return position < input.size() ? input.substr(position) : std::string_view(); }
+
+        private:
+            std::string_view input;
+            std::string_view delimiter;
+            size_t position;
+            bool skipEmpty;
+        };
 
         bool IsMaxLevel(const Player* player);
         bool IsAlliance(uint8 race);
@@ -57,6 +104,7 @@ namespace cmangos_module
         bool InDungeon(const Player* player);
         bool InRaid(const Player* player);
 
+        // Prefer the inlined visitors of ModuleItemVisitor.h, which also support stopping early
         void ForEachEquippedItem(const Player* player, std::function<void(Item*)> callback);
         void ForEachInventoryItem(const Player* player, std::function<void(Item*)> callback);
         void ForEachKeyItem(const Player* player, std::function<void(Item*)> callback);
@@ -71,6 +119,11 @@ namespace cmangos_module
         std::string name;
         std::function<bool(WorldSession*, const std::string&)> callback;
         uint32 securityLevel;
+        // Typed arguments parsed by the dispatcher before calling the handler (used instead of the callback)
+        std::vector<ModuleCommandArgument> arguments;
+        std::function<bool(WorldSession*, const ModuleCommandArgs&)> handler;
+        // Nested commands, e.g. ".prefix name subcommand"
+        std::vector<ModuleChatCommand> subcommands;
     };
 
     class Module
@@ -82,13 +135,25 @@ namespace cmangos_module
         virtual ~Module();
 
         void LoadConfig();
+        // Loads the configuration file into a new snapshot and publishes it. The previous
+        // snapshot is kept alive for a few world ticks for the threads still reading it
+        bool ReloadConfig();
         void Initialize();
 
+        // Hooks run either on the world thread or concurrently on the map update threads, see
+        // GetModuleHookThread. State shared by hooks of different maps must be thread safe,
+        // ModuleMapState and helper::GetThreadScratch (ModuleThreading.h) avoid global locks
+
         // Module Hooks
         // Use it to initialize module (gets called when OnWorldInitialized)
         virtual void OnInitialize() {}
         // Used to update the module (gets called when OnWorldUpdated)
         virtual void OnUpdate(uint32 elapsed) {}
+        // Called after a new config snapshot has been published
+        virtual void OnConfigReloaded() {}
+        // Receives the events of the deferred hooks (see RegisterDeferredHook) queued since the
+        // last world update, called once per hook from the world thread
+        virtual void OnDeferredEvents(ModuleHook hook, const std::vector<ModuleEvent>& events) {}
 
         // World Hooks
         // Called before the world loads
@@ -119,6 +184,8 @@ namespace cmangos_module
         virtual void OnBuyBackItem(Player* player, Item* item, uint32 money) {}
         // Called when a player creates an item
         virtual void OnCreateItem(Player* player, Item* item, uint32 amount) {}
+        // Called before an item of a player gets destroyed (e.g. used up consumables, reagents or quest items)
+        virtual void OnDestroyItem(Player* player, Item* item) {}
 
         // Player Gossip Hooks
         // Called before generating a gossip menu dialog. Return true to override default logic
@@ -152,10 +219,17 @@ namespace cmangos_module
         virtual void OnPreLoadFromDB(uint32 playerId) {}
         // Called after the player has been loaded from DB
         virtual void OnLoadFromDB(Player* player) {}
+        // Called after the player has been loaded from DB with the results of the character
+        // queries registered by the module (see RegisterCharacterQuery)
+        virtual void OnLoadFromDB(Player* player, const ModuleQueryResults& results) {}
         // Called when a player is saved to DB
         virtual void OnSaveToDB(Player* player) {}
+        // Called when a player is saved to DB. The statements queued into the transaction
+        // are submitted together with the other modules ones as a single async transaction
+        virtual void OnSaveToDB(Player* player, ModuleTransaction& transaction) {}
         // Called when a character gets deleted
         virtual void OnDeleteFromDB(uint32 playerId) {}
+        virtual void OnDeleteFromDB(uint32 playerId, ModuleTransaction& transaction) {}
 
         // Player Session Hooks
         // Called when a player logs out of the game
@@ -270,6 +344,9 @@ namespace cmangos_module
         virtual bool OnCalculateEffectiveCritChance(const Unit* unit, const Unit* victim, uint8 attType, const SpellEntry* ability, float& outChance) { return false; }
         // Called when calculating the effective miss chance of an attack. Return true to override default logic
         virtual bool OnCalculateEffectiveMissChance(const Unit* unit, const Unit* victim, uint8 attType, const SpellEntry* ability, const Spell* const* currentSpells, const SpellPartialResistDistribution& spellPartialResistDistribution, float& outChance) { return false; }
+        // Called once per attack roll to set the miss, dodge, parry, block and crit chances together, instead
+        // of implementing the single chance hooks above. Modules with a higher priority set the table first
+        virtual void OnCalculateAttackTable(const Unit* attacker, const Unit* victim, uint8 attType, const SpellEntry* ability, ModuleAttackTable& table) {}
         // Called when calculating the spell miss chance of an attack. Return true to override default logic
         virtual bool OnCalculateSpellMissChance(const Unit* unit, const Unit* victim, uint32 schoolMask, const SpellEntry* spell, float& outChance) { return false; }
         // Called when calculating the attack distance. Return true to override default logic
@@ -362,12 +439,87 @@ namespace cmangos_module
         virtual const char* GetChatCommandPrefix() const { return nullptr; }
         virtual std::vector<ModuleChatCommand>* GetCommandTable() { return nullptr; }
 
+        // Returns true if the module should receive the given hook
+        bool HasHook(ModuleHook hook) const { return !declaredHooks || hooks.test(static_cast<size_t>(hook)); }
+        bool HasDeferredHook(ModuleHook hook) const { return deferredHooks.test(static_cast<size_t>(hook)); }
+        int32 GetHookPriority(ModuleHook hook) const;
+        // Returns the spells the module handles on a spell hook, null if it handles all of them
+        const ModuleSpellFilter* GetSpellFilter(ModuleHook hook) const;
+        // Returns the creatures the module handles on a creature hook, null if it handles all of them
+        const ModuleCreatureFilter* GetCreatureFilter(ModuleHook hook) const;
+        bool IsChanceCached(ModuleHook hook) const { return chanceCachedHooks.test(static_cast<size_t>(hook)); }
+        const std::string& GetName() const { return name; }
+        uint32 GetId() const { return id; }
+
     protected:
-        virtual const ModuleConfig* GetConfig() const { return config; }
+        virtual const ModuleConfig* GetConfig() const { return config.load(std::memory_order_acquire); }
+
+        // Declare the hooks implemented by the module (call it from the constructor).
+        // Modules that don't declare any hook will receive all of them
+        void RegisterHook(ModuleHook hook);
+        void RegisterHooks(std::initializer_list<ModuleHook> hookList);
+        // Declare a hook with a dispatch priority (default 0). Modules with a higher priority get
+        // called first, and override hooks stop at the first module that returns true
+        void RegisterHook(ModuleHook hook, int32 priority);
+        // Receive a notification hook (see IsModuleEventHook) in batches through OnDeferredEvents
+        // instead of synchronously, keeping the module work out of the combat and reward code
+        void RegisterDeferredHook(ModuleHook hook);
+        // Receive a spell hook (OnCast, OnHit, OnProc or OnPeriodicTick) only for the given spell ids or
+        // spell families instead of every spell. OnProc is filtered by the spell of the aura that procs
+        void RegisterSpellHook(ModuleHook hook, const std::vector<uint32>& spellIds);
+        void RegisterSpellFamilyHook(ModuleHook hook, const std::vector<uint32>& spellFamilies);
+        // Receive a creature hook (OnAddToWorld, OnRespawn or OnRespawnRequest) only for the given creature
+        // entries or the creatures with any of the npc flags instead of every creature, e.g. every spawn of a loading grid
+        void RegisterCreatureHook(ModuleHook hook, const std::vector<uint32>& entries);
+        void RegisterCreatureNpcFlagHook(ModuleHook hook, uint32 npcFlags);
+        // Memoize the chances returned by a chance hook (e.g. OnCalculateEffectiveCritChance) per unit, target,
+        // attack type or school, spell and chance passed in. Only for modules whose chances depend on those
+        // inputs and on the gear, level, talents and config alone (not on the auras they read themselves),
+        // see ModuleChanceCache for when they get calculated again
+        void UseChanceCache(ModuleHook hook);
+
+        // Register a task that runs every interval (ms) from the world update within the
+        // module time budget. The callback receives the time elapsed since its last run
+        uint32 RegisterTask(const std::string& taskName, uint32 interval, ModuleTaskCost cost, ModuleTaskCallback callback);
+        void RemoveTask(uint32 taskId);
+
+        // Register a query (call it from the constructor) that loads the module data of a character
+        // together with the core login queries. The character guid is given with a single %u, e.g.
+        // "SELECT data FROM custom_mymodule_character WHERE guid = '%u'". Returns the query id
+        // used to get the result on OnLoadFromDB
+        uint32 RegisterCharacterQuery(const std::string& query);
+
+        // Enable the per player inventory index (call it from the constructor). The index is kept
+        // up to date from the item hooks and answers which items a player owns without scanning
+        void UseInventoryIndex();
+        const ModuleInventoryIndex* GetInventoryIndex(const Player* player) const;
+
+        // Register a state kept for every online player (call it from the constructor) instead of a
+        // container keyed by guid. It gets constructed when the player loads, before OnLoadFromDB, and
+        // destroyed after OnLogOut, e.g. ModulePlayerSlot<Streak> streaks = RegisterPlayerState<Streak>();
+        // and then streaks.Get(player) from any hook of the player
+        template<typename T>
+        ModulePlayerSlot<T> RegisterPlayerState()
+        {
+            uint32 offset = 0;
+            const ModulePlayerStates* states = RegisterPlayerState(sizeof(T), alignof(T), [](void* data) { new (data) T(); }, [](void* data) { static_cast<T*>(data)->~T(); }, offset);
+            return ModulePlayerSlot<T>(states, offset);
+        }
+
+    private:
+        const ModulePlayerStates* RegisterPlayerState(uint32 size, uint32 alignment, ModulePlayerStates::Constructor constructor, ModulePlayerStates::Destructor destructor, uint32& outOffset);
 
     private:
-        ModuleConfig* config;
+        std::atomic<ModuleConfig*> config;
         std::string name;
+        std::bitset<MODULE_HOOK_COUNT> hooks;
+        std::bitset<MODULE_HOOK_COUNT> deferredHooks;
+        std::bitset<MODULE_HOOK_COUNT> chanceCachedHooks;
+        std::map<ModuleHook, int32> hookPriorities;
+        std::map<ModuleHook, ModuleSpellFilter> spellFilters;
+        std::map<ModuleHook, ModuleCreatureFilter> creatureFilters;
+        bool declaredHooks;
+        uint32 id;
     };
 }
 
@@ -0,0 +1,38 @@
+#ifndef CMANGOS_MODULE_ATTACK_TABLE_H
+#define CMANGOS_MODULE_ATTACK_TABLE_H
+
+#include "Platform/Define.h"
+
+#include <algorithm>
+#include <array>
+
+namespace cmangos_module
+{
+    // Outcomes of a melee or ranged attack roll that modules can set in one call
+    enum class ModuleAttackOutcome : uint8
+    {
+        Miss,
+        Dodge,
+        Parry,
+        Block,
+        Crit,
+        MAX
+    };
+
+    // Chances (in percent) of the outcomes of an attack. Outcomes left unset keep the chance
+    // calculated by the core
+    struct ModuleAttackTable
+    {
+        ModuleAttackTable() { Reset(); }
+
+        void Reset() { chances.fill(-1.0f); }
+        void Set(ModuleAttackOutcome outcome, float chance) { chances[static_cast<size_t>(outcome)] = std::max(chance, 0.0f); }
+        bool Has(ModuleAttackOutcome outcome) const { return chances[static_cast<size_t>(outcome)] >= 0.0f; }
+        float Get(ModuleAttackOutcome outcome) const { return chances[static_cast<size_t>(outcome)]; }
+
+    private:
+        std::array<float, static_cast<size_t>(ModuleAttackOutcome::MAX)> chances;
+    };
+}
+
+#endif
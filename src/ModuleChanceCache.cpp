@@ -0,0 +1,131 @@
+#include "ModuleChanceCache.h"
+
+#include "Entities/Unit.h"
+
+#include <cstring>
+
+namespace cmangos_module
+{
+    bool IsModuleChanceHook(ModuleHook hook)
+    {
+        switch (hook)
+        {
+            case ModuleHook::OnCalculateEffectiveDodgeChance:
+            case ModuleHook::OnCalculateEffectiveBlockChance:
+            case ModuleHook::OnCalculateEffectiveParryChance:
+            case ModuleHook::OnCalculateEffectiveCritChance:
+            case ModuleHook::OnCalculateSpellMissChance:
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    size_t ModuleChanceCache::KeyHash::operator()(const Key& key) const
+    {
+        uint64 hash = key.unit * 0x9E3779B97F4A7C15ULL;
+        hash ^= key.target + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+        hash ^= (uint64(key.variant) << 32 | key.spellId) + (hash << 6) + (hash >> 2);
+        hash ^= (uint64(key.moduleId) << 32 | key.hook) + (hash << 6) + (hash >> 2);
+        hash ^= key.input + (hash << 6) + (hash >> 2);
+        return static_cast<size_t>(hash);
+    }
+
+    ModuleChanceCache::Key ModuleChanceCache::CreateKey(ModuleHook hook, uint32 moduleId, const Unit* unit, const Unit* target, uint32 variant, uint32 spellId, float inputChance)
+    {
+        Key key;
+        key.unit = unit->GetObjectGuid().GetRawValue();
+        key.target = target ? target->GetObjectGuid().GetRawValue() : 0;
+        key.variant = variant;
+        key.spellId = spellId;
+        key.moduleId = moduleId;
+        key.hook = static_cast<uint32>(hook);
+        std::memcpy(&key.input, &inputChance, sizeof(key.input));
+        return key;
+    }
+
+    ModuleChanceCache::MapCache& ModuleChanceCache::GetMapCache(const Unit* unit)
+    {
+        MapCache& cache = maps.Get(unit->GetMap());
+        const uint32 currentEpoch = epoch.load(std::memory_order_relaxed);
+        if (cache.epoch != currentEpoch)
+        {
+            cache.entries.clear();
+            cache.epoch = currentEpoch;
+        }
+
+        return cache;
+    }
+
+    bool ModuleChanceCache::Get(ModuleHook hook, uint32 moduleId, const Unit* unit, const Unit* target, uint32 variant, uint32 spellId, float inputChance, bool& outOverriden, float& outChance)
+    {
+        // Units out of the world have no thread owning their cache (and GetMap asserts on them)
+        if (!unit || !unit->IsInWorld())
+        {
+            return false;
+        }
+
+        MapCache& cache = GetMapCache(unit);
+        auto entryIt = cache.entries.find(CreateKey(hook, moduleId, unit, target, variant, spellId, inputChance));
+        if (entryIt == cache.entries.end())
+        {
+            return false;
+        }
+
+        const Entry& entry = entryIt->second;
+        if (int32(entry.expireTime - time.load(std::memory_order_relaxed)) <= 0)
+        {
+            cache.entries.erase(entryIt);
+            return false;
+        }
+
+        outOverriden = entry.overriden;
+        outChance = entry.chance;
+        return true;
+    }
+
+    void ModuleChanceCache::Set(ModuleHook hook, uint32 moduleId, const Unit* unit, const Unit* target, uint32 variant, uint32 spellId, float inputChance, bool overriden, float chance)
+    {
+        if (!unit || !unit->IsInWorld())
+        {
+            return;
+        }
+
+        MapCache& cache = GetMapCache(unit);
+        if (cache.entries.size() >= MODULE_CHANCE_CACHE_MAX_ENTRIES)
+        {
+            cache.entries.clear();
+        }
+
+        const uint32 expireTime = time.load(std::memory_order_relaxed) + MODULE_CHANCE_CACHE_TTL;
+        cache.entries[CreateKey(hook, moduleId, unit, target, variant, spellId, inputChance)] = { chance, overriden, expireTime };
+    }
+
+    void ModuleChanceCache::Invalidate(const Unit* unit)
+    {
+        if (enabled && unit && unit->IsInWorld())
+        {
+            // Other units of the map may have memoized chances against this one, drop them all
+            maps.Get(unit->GetMap()).entries.clear();
+        }
+    }
+
+    void ModuleChanceCache::Update(uint32 elapsed)
+    {
+        if (!enabled)
+        {
+            return;
+        }
+
+        time.fetch_add(elapsed, std::memory_order_relaxed);
+
+        // Also gets rid of the caches of the unloaded instances
+        pruneTimer += elapsed;
+        if (pruneTimer >= MODULE_CHANCE_CACHE_PRUNE_INTERVAL)
+        {
+            pruneTimer = 0;
+            maps.Clear();
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef CMANGOS_MODULE_CHANCE_CACHE_H
+#define CMANGOS_MODULE_CHANCE_CACHE_H
+
+#include "Common.h"
+#include "Platform/Define.h"
+#include "ModuleHook.h"
+#include "ModuleThreading.h"
+
+#include <atomic>
+#include <unordered_map>
+
+class Unit;
+
+namespace cmangos_module
+{
+    // Time a memoized chance is used before asking the module again (ms). Aura changes don't go
+    // through any hook, so this is how long a module that reads the auras itself may miss them
+    constexpr uint32 MODULE_CHANCE_CACHE_TTL = 1 * IN_MILLISECONDS;
+    // Entries a map keeps before dropping them all
+    constexpr uint32 MODULE_CHANCE_CACHE_MAX_ENTRIES = 8192;
+    // Interval between the removals of the caches of every map, including the unloaded ones (ms)
+    constexpr uint32 MODULE_CHANCE_CACHE_PRUNE_INTERVAL = 60 * IN_MILLISECONDS;
+
+    // Chance hooks a module can memoize (see Module::UseChanceCache). OnCalculateEffectiveMissChance isn't
+    // one of them, its result may depend on the spells being cast
+    bool IsModuleChanceHook(ModuleHook hook);
+
+    // Chances returned by the modules per (unit, target, attack type or school, spell, chance passed in).
+    // The chance passed in is part of the key, so a module adjusting the chance calculated before it is
+    // asked again when that chance changes. It is kept per map so it can be used from the map update
+    // threads, and gets invalidated when the gear, level or talents of a unit of the map change, when a
+    // config gets reloaded and after MODULE_CHANCE_CACHE_TTL
+    class ModuleChanceCache
+    {
+    public:
+        ModuleChanceCache() : time(0), epoch(0), pruneTimer(0), enabled(false) {}
+
+        void Enable() { enabled = true; }
+        bool IsEnabled() const { return enabled; }
+
+        bool Get(ModuleHook hook, uint32 moduleId, const Unit* unit, const Unit* target, uint32 variant, uint32 spellId, float inputChance, bool& outOverriden, float& outChance);
+        void Set(ModuleHook hook, uint32 moduleId, const Unit* unit, const Unit* target, uint32 variant, uint32 spellId, float inputChance, bool overriden, float chance);
+
+        // Drops the chances of the map of the unit. Must be called from the thread updating the unit
+        void Invalidate(const Unit* unit);
+        // Drops every chance, e.g. when a module config changes
+        void InvalidateAll() { epoch.fetch_add(1, std::memory_order_relaxed); }
+
+        // Called from the world update
+        void Update(uint32 elapsed);
+
+    private:
+        struct Key
+        {
+            uint64 unit;
+            uint64 target;
+            uint32 variant;
+            uint32 spellId;
+            uint32 moduleId;
+            uint32 hook;
+            // Bits of the chance passed in
+            uint32 input;
+
+            bool operator==(const Key& key) const
+            {
+                return unit == key.unit && target == key.target && variant == key.variant && spellId == key.spellId && moduleId == key.moduleId && hook == key.hook && input == key.input;
+            }
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const;
+        };
+
+        struct Entry
+        {
+            float chance;
+            bool overriden;
+            uint32 expireTime;
+        };
+
+        struct MapCache
+        {
+            MapCache() : epoch(0) {}
+
+            std::unordered_map<Key, Entry, KeyHash> entries;
+            uint32 epoch;
+        };
+
+        static Key CreateKey(ModuleHook hook, uint32 moduleId, const Unit* unit, const Unit* target, uint32 variant, uint32 spellId, float inputChance);
+        MapCache& GetMapCache(const Unit* unit);
+
+    private:
+        ModuleMapState<MapCache> maps;
+        std::atomic<uint32> time;
+        std::atomic<uint32> epoch;
+        uint32 pruneTimer;
+        bool enabled;
+    };
+}
+
+#endif
@@ -0,0 +1,179 @@
+#include "ModuleCommand.h"
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace cmangos_module
+{
+    namespace
+    {
+        std::string_view NextToken(std::string_view& input)
+        {
+            const size_t start = input.find_first_not_of(' ');
+            if (start == std::string_view::npos)
+            {
+                input = std::string_view();
+                return std::string_view();
+            }
+
+            input.remove_prefix(start);
+            const size_t end = input.find(' ');
+            const std::string_view token = input.substr(0, end);
+            input.remove_prefix(end == std::string_view::npos ? input.size() : end);
+            return token;
+        }
+
+        // Names are UTF-8, so the limit counts characters rather than bytes. Which characters are
+        // allowed is up to the realm's name settings, the name lookup rejects the rest
+        bool IsValidPlayerName(std::string_view name)
+        {
+            size_t length = 0;
+            for (const char c : name)
+            {
+                if ((static_cast<unsigned char>(c) & 0xC0) != 0x80)
+                {
+                    ++length;
+                }
+            }
+
+            return length >= 2 && length <= MODULE_COMMAND_MAX_NAME_LENGTH;
+        }
+    }
+
+    bool ModuleCommandArgs::Parse(const std::vector<ModuleCommandArgument>& schema, std::string_view input)
+    {
+        count = 0;
+        if (schema.size() > MODULE_COMMAND_MAX_ARGS)
+        {
+            return false;
+        }
+
+        for (const ModuleCommandArgument& argument : schema)
+        {
+            Value& value = values[count];
+            value.number.u = 0;
+
+            if (argument.type == ModuleCommandArg::String)
+            {
+                const size_t start = input.find_first_not_of(' ');
+                value.str = start != std::string_view::npos ? input.substr(start) : std::string_view();
+                input = std::string_view();
+                if (value.str.empty())
+                {
+                    return argument.optional;
+                }
+
+                ++count;
+                continue;
+            }
+
+            const std::string_view token = NextToken(input);
+            if (token.empty())
+            {
+                return argument.optional;
+            }
+
+            value.str = token;
+            const char* first = token.data();
+            const char* last = token.data() + token.size();
+            switch (argument.type)
+            {
+                case ModuleCommandArg::Int:
+                {
+                    const std::from_chars_result result = std::from_chars(first, last, value.number.i);
+                    if (result.ec != std::errc() || result.ptr != last || value.number.i < INT32_MIN || value.number.i > INT32_MAX)
+                    {
+                        return false;
+                    }
+
+                    break;
+                }
+
+                case ModuleCommandArg::UInt:
+                {
+                    const std::from_chars_result result = std::from_chars(first, last, value.number.u);
+                    if (result.ec != std::errc() || result.ptr != last || value.number.u > UINT32_MAX)
+                    {
+                        return false;
+                    }
+
+                    break;
+                }
+
+                case ModuleCommandArg::Guid:
+                {
+                    const bool hex = token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X');
+                    const std::from_chars_result result = std::from_chars(hex ? first + 2 : first, last, value.number.u, hex ? 16 : 10);
+                    if (result.ec != std::errc() || result.ptr != last)
+                    {
+                        return false;
+                    }
+
+                    break;
+                }
+
+                case ModuleCommandArg::Float:
+                {
+                    // Not every supported compiler implements from_chars for floats yet
+                    char buffer[32];
+                    if (token.size() >= sizeof(buffer))
+                    {
+                        return false;
+                    }
+
+                    memcpy(buffer, first, token.size());
+                    buffer[token.size()] = '\0';
+
+                    char* end = nullptr;
+                    value.number.f = std::strtof(buffer, &end);
+                    if (end != buffer + token.size())
+                    {
+                        return false;
+                    }
+
+                    break;
+                }
+
+                case ModuleCommandArg::PlayerName:
+                {
+                    if (!IsValidPlayerName(token))
+                    {
+                        return false;
+                    }
+
+                    break;
+                }
+
+                default:
+                {
+                    return false;
+                }
+            }
+
+            ++count;
+        }
+
+        // Reject extra arguments
+        return input.find_first_not_of(' ') == std::string_view::npos;
+    }
+
+    std::string ModuleCommandArgs::GetUsage(const std::vector<ModuleCommandArgument>& schema)
+    {
+        std::string usage;
+        for (const ModuleCommandArgument& argument : schema)
+        {
+            if (!usage.empty())
+            {
+                usage += ' ';
+            }
+
+            usage += argument.optional ? '[' : '<';
+            usage += argument.name;
+            usage += argument.optional ? ']' : '>';
+        }
+
+        return usage;
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef CMANGOS_MODULE_COMMAND_H
+#define CMANGOS_MODULE_COMMAND_H
+
+#include "Platform/Define.h"
+#include "Entities/ObjectGuid.h"
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cmangos_module
+{
+    // Type of the arguments that the command dispatcher parses before calling the module
+    enum class ModuleCommandArg : uint8
+    {
+        Int,
+        UInt,
+        Float,
+        // Raw guid value, decimal or hexadecimal (0x)
+        Guid,
+        // Character name, 2 to 12 characters
+        PlayerName,
+        // Rest of the command line, must be the last argument
+        String
+    };
+
+    struct ModuleCommandArgument
+    {
+        std::string name;
+        ModuleCommandArg type;
+        // Optional arguments can only be followed by other optional arguments
+        bool optional;
+    };
+
+    constexpr uint32 MODULE_COMMAND_MAX_ARGS = 8;
+    // Same limit as the core's MAX_PLAYER_NAME, in characters
+    constexpr uint32 MODULE_COMMAND_MAX_NAME_LENGTH = 12;
+
+    // Arguments of a module command parsed against its schema. The string values are
+    // views into the command line so they are only valid during the command handler
+    class ModuleCommandArgs
+    {
+    public:
+        ModuleCommandArgs() : count(0) {}
+
+        // Returns false if the input doesn't match the schema
+        bool Parse(const std::vector<ModuleCommandArgument>& schema, std::string_view input);
+
+        uint32 GetCount() const { return count; }
+        bool Has(uint32 index) const { return index < count; }
+
+        int32 GetInt(uint32 index) const { return Has(index) ? static_cast<int32>(values[index].number.i) : 0; }
+        uint32 GetUInt(uint32 index) const { return Has(index) ? static_cast<uint32>(values[index].number.u) : 0; }
+        float GetFloat(uint32 index) const { return Has(index) ? values[index].number.f : 0.0f; }
+        ObjectGuid GetGuid(uint32 index) const { return Has(index) ? ObjectGuid(values[index].number.u) : ObjectGuid(); }
+        std::string_view GetString(uint32 index) const { return Has(index) ? values[index].str : std::string_view(); }
+
+        // Builds the usage text of a schema, e.g. "<target> [amount]"
+        static std::string GetUsage(const std::vector<ModuleCommandArgument>& schema);
+
+    private:
+        struct Value
+        {
+            union
+            {
+                int64 i;
+                uint64 u;
+                float f;
+            } number;
+            std::string_view str;
+        };
+
+        std::array<Value, MODULE_COMMAND_MAX_ARGS> values;
+        uint32 count;
+    };
+}
+
+#endif
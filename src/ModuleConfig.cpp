@@ -3,18 +3,52 @@
 #include "Log/Log.h"
 #include "SystemConfig.h"
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+
 namespace cmangos_module
 {
+    namespace
+    {
+        template<typename T>
+        bool ParseInteger(const std::string& value, T& result)
+        {
+            const char* first = value.data();
+            const char* last = value.data() + value.size();
+            const std::from_chars_result parsed = std::from_chars(first, last, result);
+            return parsed.ec == std::errc() && parsed.ptr == last;
+        }
+
+        std::string Trim(const std::string& value)
+        {
+            const size_t first = value.find_first_not_of(" \t");
+            const size_t last = value.find_last_not_of(" \t");
+            return first != std::string::npos ? value.substr(first, last - first + 1) : std::string();
+        }
+    }
+
     ModuleConfig::ModuleConfig(const std::string& filename)
     : filename(filename)
     {
 
     }
 
+    std::string ModuleConfig::GetFilePath() const
+    {
+        return SYSCONFDIR + filename;
+    }
+
     bool ModuleConfig::Load()
     {
-        if (config.SetSource(SYSCONFDIR + filename, ""))
+        if (config.SetSource(GetFilePath(), ""))
         {
+            for (const std::function<void()>& binding : bindings)
+            {
+                binding();
+            }
+
             return OnLoad();
         }
         else
@@ -23,4 +57,140 @@ namespace cmangos_module
             return false;
         }
     }
-}
\ No newline at end of file
+
+    void ModuleConfig::Bind(const char* name, bool& field, bool defaultValue)
+    {
+        bindings.push_back([this, name, &field, defaultValue]()
+        {
+            field = config.GetBoolDefault(name, defaultValue);
+        });
+    }
+
+    void ModuleConfig::Bind(const char* name, int32& field, int32 defaultValue, int32 minValue, int32 maxValue)
+    {
+        bindings.push_back([this, name, &field, defaultValue, minValue, maxValue]()
+        {
+            field = defaultValue;
+            const std::string value = Trim(config.GetStringDefault(name, ""));
+            int32 parsed = 0;
+            if (!value.empty())
+            {
+                if (ParseInteger(value, parsed) && parsed >= minValue && parsed <= maxValue)
+                {
+                    field = parsed;
+                }
+                else
+                {
+                    LogInvalidValue(name, value);
+                }
+            }
+        });
+    }
+
+    void ModuleConfig::Bind(const char* name, uint32& field, uint32 defaultValue, uint32 minValue, uint32 maxValue)
+    {
+        bindings.push_back([this, name, &field, defaultValue, minValue, maxValue]()
+        {
+            field = defaultValue;
+            const std::string value = Trim(config.GetStringDefault(name, ""));
+            uint32 parsed = 0;
+            if (!value.empty())
+            {
+                if (ParseInteger(value, parsed) && parsed >= minValue && parsed <= maxValue)
+                {
+                    field = parsed;
+                }
+                else
+                {
+                    LogInvalidValue(name, value);
+                }
+            }
+        });
+    }
+
+    void ModuleConfig::Bind(const char* name, float& field, float defaultValue, float minValue, float maxValue)
+    {
+        bindings.push_back([this, name, &field, defaultValue, minValue, maxValue]()
+        {
+            field = defaultValue;
+            const std::string value = Trim(config.GetStringDefault(name, ""));
+            if (!value.empty())
+            {
+                char* end = nullptr;
+                const float parsed = std::strtof(value.c_str(), &end);
+                if (end == value.c_str() + value.size() && parsed >= minValue && parsed <= maxValue)
+                {
+                    field = parsed;
+                }
+                else
+                {
+                    LogInvalidValue(name, value);
+                }
+            }
+        });
+    }
+
+    void ModuleConfig::Bind(const char* name, std::string& field, const std::string& defaultValue)
+    {
+        bindings.push_back([this, name, &field, defaultValue]()
+        {
+            field = config.GetStringDefault(name, defaultValue);
+        });
+    }
+
+    void ModuleConfig::Bind(const char* name, std::vector<uint32>& field, const std::string& defaultValue)
+    {
+        bindings.push_back([this, name, &field, defaultValue]()
+        {
+            ParseIdList(name, config.GetStringDefault(name, defaultValue), field);
+        });
+    }
+
+    void ModuleConfig::ParseIdList(const char* name, const std::string& value, std::vector<uint32>& ids)
+    {
+        ids.clear();
+        size_t start = 0;
+        while (start <= value.size())
+        {
+            size_t end = value.find(',', start);
+            if (end == std::string::npos)
+            {
+                end = value.size();
+            }
+
+            const std::string token = Trim(value.substr(start, end - start));
+            uint32 id = 0;
+            if (ParseInteger(token, id))
+            {
+                ids.push_back(id);
+            }
+            else if (!token.empty())
+            {
+                LogInvalidId(name, token);
+            }
+
+            start = end + 1;
+        }
+
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+
+    bool ModuleConfig::IsSameName(const std::string& a, const std::string& b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y)
+        {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    void ModuleConfig::LogInvalidId(const char* name, const std::string& id)
+    {
+        sLog.outError("Invalid id '%s' in the config entry %s, it will be ignored", id.c_str(), name);
+    }
+
+    void ModuleConfig::LogInvalidValue(const char* name, const std::string& value) const
+    {
+        sLog.outError("Invalid value '%s' for the config entry %s in %s, using the default", value.c_str(), name, filename.c_str());
+    }
+}
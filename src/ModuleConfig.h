@@ -3,6 +3,14 @@
 
 #include "Config/Config.h"
 
+#include <bitset>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace cmangos_module
 {
     class ModuleConfig
@@ -13,13 +21,92 @@ namespace cmangos_module
 
         bool Load();
 
+        // Creates a new, not loaded config of the same type. It is used to reload the configuration
+        // file into a new snapshot while the current one is still in use by other threads.
+        // Modules supporting reloading must override it and always read the config through
+        // Module::GetConfig instead of keeping a pointer to it
+        virtual ModuleConfig* CreateSnapshot() const { return nullptr; }
+
+        const std::string& GetFilename() const { return filename; }
+        std::string GetFilePath() const;
+
     protected:
-        virtual bool OnLoad() = 0;
+        // Called after the bound fields have been loaded
+        virtual bool OnLoad() { return true; }
+
+        // Bind the fields of the config class to their config entries (call them from the
+        // constructor). The values get parsed and validated once when loading the file and
+        // invalid or out of range values fall back to the default
+        void Bind(const char* name, bool& field, bool defaultValue);
+        void Bind(const char* name, int32& field, int32 defaultValue, int32 minValue = std::numeric_limits<int32>::min(), int32 maxValue = std::numeric_limits<int32>::max());
+        void Bind(const char* name, uint32& field, uint32 defaultValue, uint32 minValue = 0, uint32 maxValue = std::numeric_limits<uint32>::max());
+        void Bind(const char* name, float& field, float defaultValue, float minValue = std::numeric_limits<float>::lowest(), float maxValue = std::numeric_limits<float>::max());
+        void Bind(const char* name, std::string& field, const std::string& defaultValue);
+        // Comma separated list of ids, loaded sorted and without duplicates (use std::binary_search)
+        void Bind(const char* name, std::vector<uint32>& field, const std::string& defaultValue);
+
+        // Comma separated list of ids lower than N
+        template<size_t N>
+        void Bind(const char* name, std::bitset<N>& field, const std::string& defaultValue)
+        {
+            bindings.push_back([this, name, &field, defaultValue]()
+            {
+                std::vector<uint32> ids;
+                ParseIdList(name, config.GetStringDefault(name, defaultValue), ids);
+
+                field.reset();
+                for (uint32 id : ids)
+                {
+                    if (id < N)
+                    {
+                        field.set(id);
+                    }
+                    else
+                    {
+                        LogInvalidId(name, std::to_string(id));
+                    }
+                }
+            });
+        }
+
+        // Enum given either by one of the names or by its numeric value
+        template<typename Enum>
+        void Bind(const char* name, Enum& field, Enum defaultValue, std::initializer_list<std::pair<const char*, Enum>> values)
+        {
+            std::vector<std::pair<std::string, Enum>> names(values.begin(), values.end());
+            bindings.push_back([this, name, &field, defaultValue, names]()
+            {
+                field = defaultValue;
+                const std::string value = config.GetStringDefault(name, "");
+                if (!value.empty())
+                {
+                    for (const auto& namePair : names)
+                    {
+                        if (IsSameName(namePair.first, value) || std::to_string(static_cast<int64>(namePair.second)) == value)
+                        {
+                            field = namePair.second;
+                            return;
+                        }
+                    }
+
+                    LogInvalidValue(name, value);
+                }
+            });
+        }
+
+    private:
+        static void ParseIdList(const char* name, const std::string& value, std::vector<uint32>& ids);
+        static bool IsSameName(const std::string& a, const std::string& b);
+        static void LogInvalidId(const char* name, const std::string& id);
+        void LogInvalidValue(const char* name, const std::string& value) const;
 
     protected:
         std::string filename;
         Config config;
+
+    private:
+        std::vector<std::function<void()>> bindings;
     };
 }
 
-#endif
\ No newline at end of file
+#endif
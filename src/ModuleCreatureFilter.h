@@ -0,0 +1,70 @@
+#ifndef CMANGOS_MODULE_CREATURE_FILTER_H
+#define CMANGOS_MODULE_CREATURE_FILTER_H
+
+#include "Platform/Define.h"
+#include "ModuleHook.h"
+
+#include <vector>
+
+namespace cmangos_module
+{
+    // Hooks that can be filtered by creature (see Module::RegisterCreatureHook)
+    inline bool IsModuleCreatureHook(ModuleHook hook)
+    {
+        return hook == ModuleHook::OnAddToWorld || hook == ModuleHook::OnRespawn || hook == ModuleHook::OnRespawnRequest;
+    }
+
+    // Set of creature entries and npc flags a module handles on a creature hook, kept as a bitset
+    // over the entries so the creatures of a loading grid that nobody filters on are skipped cheaply
+    class ModuleCreatureFilter
+    {
+    public:
+        ModuleCreatureFilter() : npcFlags(0) {}
+
+        void AddEntry(uint32 entry)
+        {
+            const size_t word = entry / 64;
+            if (word >= entries.size())
+            {
+                entries.resize(word + 1, 0);
+            }
+
+            entries[word] |= uint64(1) << (entry % 64);
+        }
+
+        // Creatures with any of the npc flags (UNIT_NPC_FLAG_*) set
+        void AddNpcFlags(uint32 flags) { npcFlags |= flags; }
+
+        void Merge(const ModuleCreatureFilter& filter)
+        {
+            if (filter.entries.size() > entries.size())
+            {
+                entries.resize(filter.entries.size(), 0);
+            }
+
+            for (size_t i = 0; i < filter.entries.size(); ++i)
+            {
+                entries[i] |= filter.entries[i];
+            }
+
+            npcFlags |= filter.npcFlags;
+        }
+
+        bool HasEntry(uint32 entry) const
+        {
+            const size_t word = entry / 64;
+            return word < entries.size() && (entries[word] & (uint64(1) << (entry % 64))) != 0;
+        }
+
+        bool HasNpcFlags(uint32 flags) const { return (npcFlags & flags) != 0; }
+        bool UsesNpcFlags() const { return npcFlags != 0; }
+        bool Matches(uint32 entry, uint32 flags) const { return HasEntry(entry) || HasNpcFlags(flags); }
+        bool IsEmpty() const { return entries.empty() && !npcFlags; }
+
+    private:
+        std::vector<uint64> entries;
+        uint32 npcFlags;
+    };
+}
+
+#endif
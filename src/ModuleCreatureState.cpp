@@ -0,0 +1,39 @@
+#include "ModuleCreatureState.h"
+#include "ModuleMgr.h"
+
+#include "Entities/Creature.h"
+#include "Maps/Map.h"
+#include "Maps/MapManager.h"
+
+namespace cmangos_module
+{
+    ModuleCreatureStateBase::ModuleCreatureStateBase()
+    {
+        sModuleMgr.RegisterCreatureState(this);
+    }
+
+    ModuleCreatureStateBase::~ModuleCreatureStateBase()
+    {
+        sModuleMgr.UnregisterCreatureState(this);
+    }
+
+    const Map* ModuleCreatureStateBase::GetMap(const Creature* creature)
+    {
+        return creature->GetMap();
+    }
+
+    ObjectGuid ModuleCreatureStateBase::GetGuid(const Creature* creature)
+    {
+        return creature->GetObjectGuid();
+    }
+
+    Map* ModuleCreatureStateBase::FindMap(uint32 mapId, uint32 instanceId)
+    {
+        return sMapMgr.FindMap(mapId, instanceId);
+    }
+
+    bool ModuleCreatureStateBase::IsInMap(Map* map, ObjectGuid guid, const Creature* owner)
+    {
+        return map->GetAnyTypeCreature(guid) == owner;
+    }
+}
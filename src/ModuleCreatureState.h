@@ -0,0 +1,226 @@
+#ifndef CMANGOS_MODULE_CREATURE_STATE_H
+#define CMANGOS_MODULE_CREATURE_STATE_H
+
+#include "Common.h"
+#include "Platform/Define.h"
+#include "Entities/ObjectGuid.h"
+#include "ModuleThreading.h"
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+class Creature;
+
+namespace cmangos_module
+{
+    // Creatures with consecutive guids whose states are allocated together
+    constexpr uint32 MODULE_CREATURE_STATE_PAGE_SIZE = 256;
+    // Interval between the sweeps that drop the states of the creatures gone from their map (ms)
+    constexpr uint32 MODULE_CREATURE_STATE_SWEEP_INTERVAL = 30 * IN_MILLISECONDS;
+
+    // Part of ModuleCreatureState the module manager drives. It registers itself on construction
+    class ModuleCreatureStateBase
+    {
+    public:
+        ModuleCreatureStateBase();
+        virtual ~ModuleCreatureStateBase();
+
+        ModuleCreatureStateBase(const ModuleCreatureStateBase&) = delete;
+        ModuleCreatureStateBase& operator=(const ModuleCreatureStateBase&) = delete;
+
+        // Drops the state left by a previous creature with the same guid. Called before the modules get OnAddToWorld
+        virtual void OnAddToWorld(const Creature* creature) = 0;
+        // Drops the states of the creatures gone from their map (e.g. on grid unload) and the tables
+        // of the unloaded maps. Called from the world thread while no map is being updated
+        virtual void Sweep() = 0;
+
+    protected:
+        static const Map* GetMap(const Creature* creature);
+        static ObjectGuid GetGuid(const Creature* creature);
+        // Null once the map got unloaded
+        static Map* FindMap(uint32 mapId, uint32 instanceId);
+        // True while the creature is in the map. The owner is only compared, it may be gone already
+        static bool IsInMap(Map* map, ObjectGuid guid, const Creature* owner);
+    };
+
+    // Module state of type T attached to the creatures in the world, e.g.
+    // ModuleCreatureState<RareSpawn> rares; ... ++rares.Get(creature).respawns;
+    // The states are kept per map in pages indexed by the map local guid of the creatures, so a lookup
+    // is a couple of array accesses. A state is created on first use and it is reset when a creature
+    // with the same guid enters the world. Once the creature leaves its map the state is kept until the
+    // next sweep (MODULE_CREATURE_STATE_SWEEP_INTERVAL) frees it. The states of a map must only be
+    // accessed from the thread updating it (see ModuleMapState)
+    template<typename T>
+    class ModuleCreatureState : public ModuleCreatureStateBase
+    {
+    public:
+        // State of the creature, created on first use
+        T& Get(const Creature* creature)
+        {
+            const ObjectGuid guid = GetGuid(creature);
+            Page& page = GetPage(GetTable(creature), guid);
+            const uint32 index = guid.GetCounter() % MODULE_CREATURE_STATE_PAGE_SIZE;
+            if (page.values[index] && page.owners[index] != creature)
+            {
+                Reset(page, index);
+            }
+
+            if (!page.values[index])
+            {
+                page.values[index].emplace();
+                page.owners[index] = creature;
+                page.guids[index] = guid;
+                ++page.count;
+            }
+
+            return *page.values[index];
+        }
+
+        // State of the creature, null if it has none
+        T* Find(const Creature* creature)
+        {
+            const ObjectGuid guid = GetGuid(creature);
+            Page* page = FindPage(GetTable(creature), guid);
+            const uint32 index = guid.GetCounter() % MODULE_CREATURE_STATE_PAGE_SIZE;
+            return page && page->values[index] && page->owners[index] == creature ? &*page->values[index] : nullptr;
+        }
+
+        void Remove(const Creature* creature)
+        {
+            const ObjectGuid guid = GetGuid(creature);
+            Page* page = FindPage(GetTable(creature), guid);
+            const uint32 index = guid.GetCounter() % MODULE_CREATURE_STATE_PAGE_SIZE;
+            if (page && page->values[index] && page->owners[index] == creature)
+            {
+                Reset(*page, index);
+            }
+        }
+
+        void OnAddToWorld(const Creature* creature) override
+        {
+            const ObjectGuid guid = GetGuid(creature);
+            Page* page = FindPage(GetTable(creature), guid);
+            const uint32 index = guid.GetCounter() % MODULE_CREATURE_STATE_PAGE_SIZE;
+            if (page && page->values[index])
+            {
+                Reset(*page, index);
+            }
+        }
+
+        void Sweep() override
+        {
+            std::vector<std::pair<uint32, uint32>>& unloadedMaps = helper::GetThreadScratch<std::vector<std::pair<uint32, uint32>>, ModuleCreatureStateBase>();
+            maps.ForEach([&](MapTable& table)
+            {
+                Map* map = FindMap(table.mapId, table.instanceId);
+                if (!map)
+                {
+                    unloadedMaps.emplace_back(table.mapId, table.instanceId);
+                    return;
+                }
+
+                for (std::vector<std::unique_ptr<Page>>& pages : table.pages)
+                {
+                    for (std::unique_ptr<Page>& page : pages)
+                    {
+                        for (uint32 index = 0; page && page->count && index < MODULE_CREATURE_STATE_PAGE_SIZE; ++index)
+                        {
+                            if (page->values[index] && !IsInMap(map, page->guids[index], page->owners[index]))
+                            {
+                                Reset(*page, index);
+                            }
+                        }
+
+                        if (page && !page->count)
+                        {
+                            page.reset();
+                        }
+                    }
+                }
+            });
+
+            // The map tables can't be removed while visiting them
+            for (const std::pair<uint32, uint32>& unloadedMap : unloadedMaps)
+            {
+                maps.Remove(unloadedMap.first, unloadedMap.second);
+            }
+        }
+
+    private:
+        struct Page
+        {
+            Page() : owners(), count(0) {}
+
+            std::array<std::optional<T>, MODULE_CREATURE_STATE_PAGE_SIZE> values;
+            std::array<const Creature*, MODULE_CREATURE_STATE_PAGE_SIZE> owners;
+            std::array<ObjectGuid, MODULE_CREATURE_STATE_PAGE_SIZE> guids;
+            uint32 count;
+        };
+
+        struct MapTable
+        {
+            MapTable() : mapId(0), instanceId(0), initialized(false) {}
+
+            uint32 mapId;
+            uint32 instanceId;
+            bool initialized;
+            // Creatures and pets have their own guid counters
+            std::array<std::vector<std::unique_ptr<Page>>, 2> pages;
+        };
+
+        MapTable& GetTable(const Creature* creature)
+        {
+            const Map* map = GetMap(creature);
+            MapTable& table = maps.Get(map);
+            if (!table.initialized && map)
+            {
+                // Lets the sweep find out when the map gets unloaded
+                table.mapId = map->GetId();
+                table.instanceId = map->GetInstanceId();
+                table.initialized = true;
+            }
+
+            return table;
+        }
+
+        static Page* FindPage(MapTable& table, ObjectGuid guid)
+        {
+            const std::vector<std::unique_ptr<Page>>& pages = table.pages[guid.IsPet() ? 1 : 0];
+            const uint32 pageIndex = guid.GetCounter() / MODULE_CREATURE_STATE_PAGE_SIZE;
+            return pageIndex < pages.size() ? pages[pageIndex].get() : nullptr;
+        }
+
+        static Page& GetPage(MapTable& table, ObjectGuid guid)
+        {
+            std::vector<std::unique_ptr<Page>>& pages = table.pages[guid.IsPet() ? 1 : 0];
+            const uint32 pageIndex = guid.GetCounter() / MODULE_CREATURE_STATE_PAGE_SIZE;
+            if (pageIndex >= pages.size())
+            {
+                pages.resize(pageIndex + 1);
+            }
+
+            if (!pages[pageIndex])
+            {
+                pages[pageIndex] = std::make_unique<Page>();
+            }
+
+            return *pages[pageIndex];
+        }
+
+        static void Reset(Page& page, uint32 index)
+        {
+            page.values[index].reset();
+            page.owners[index] = nullptr;
+            page.guids[index] = ObjectGuid();
+            --page.count;
+        }
+
+    private:
+        ModuleMapState<MapTable> maps;
+    };
+}
+
+#endif
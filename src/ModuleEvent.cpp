@@ -0,0 +1,145 @@
+#include "ModuleEvent.h"
+
+#include "Entities/Unit.h"
+#include "Maps/Map.h"
+
+#include <algorithm>
+
+namespace cmangos_module
+{
+    ModuleEvent CreateModuleEvent(ModuleHook hook, const WorldObject* source, const WorldObject* target, int64 amount, uint32 extra)
+    {
+        ModuleEvent event;
+        event.source = source ? source->GetObjectGuid().GetRawValue() : 0;
+        event.target = target ? target->GetObjectGuid().GetRawValue() : 0;
+        event.amount = amount;
+        event.extra = extra;
+
+        // GetMap asserts on objects out of the world
+        const Map* map = source && source->IsInWorld() ? source->GetMap() : nullptr;
+        event.mapId = map ? map->GetId() : 0;
+        event.instanceId = map ? map->GetInstanceId() : 0;
+        event.hook = hook;
+        return event;
+    }
+
+    bool IsModuleEventHook(ModuleHook hook)
+    {
+        switch (hook)
+        {
+            case ModuleHook::OnDealDamage:
+            case ModuleHook::OnDealHeal:
+            case ModuleHook::OnKill:
+            case ModuleHook::OnGiveXP:
+            case ModuleHook::OnModifyMoney:
+            case ModuleHook::OnUpdatePlayerScore:
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    ModuleEventQueue::ModuleEventQueue()
+    : ringCount(0)
+    , overflows(0)
+    {
+        for (std::atomic<Ring*>& ring : rings)
+        {
+            ring.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ModuleEventQueue::~ModuleEventQueue()
+    {
+        for (std::atomic<Ring*>& ring : rings)
+        {
+            delete ring.exchange(nullptr);
+        }
+    }
+
+    ModuleEventQueue::Ring* ModuleEventQueue::GetThreadRing()
+    {
+        struct ThreadRing
+        {
+            const ModuleEventQueue* owner;
+            Ring* ring;
+        };
+
+        thread_local ThreadRing threadRing = { nullptr, nullptr };
+        if (threadRing.owner != this)
+        {
+            // First event of this thread, threads beyond the ring limit only use the overflow list
+            threadRing = { this, nullptr };
+            const uint32 index = ringCount.fetch_add(1, std::memory_order_relaxed);
+            if (index < MODULE_EVENT_MAX_RINGS)
+            {
+                Ring* ring = new Ring();
+                ring->head.store(0, std::memory_order_relaxed);
+                ring->tail.store(0, std::memory_order_relaxed);
+                rings[index].store(ring, std::memory_order_release);
+                threadRing.ring = ring;
+            }
+        }
+
+        return threadRing.ring;
+    }
+
+    void ModuleEventQueue::Push(const ModuleEvent& event)
+    {
+        Ring* ring = GetThreadRing();
+        if (ring)
+        {
+            const uint32 tail = ring->tail.load(std::memory_order_relaxed);
+            const uint32 head = ring->head.load(std::memory_order_acquire);
+            if (tail - head < MODULE_EVENT_RING_SIZE)
+            {
+                ring->events[tail & (MODULE_EVENT_RING_SIZE - 1)] = event;
+                ring->tail.store(tail + 1, std::memory_order_release);
+                return;
+            }
+        }
+
+        PushOverflow(event);
+    }
+
+    void ModuleEventQueue::PushOverflow(const ModuleEvent& event)
+    {
+        // The ring is full until the next world update drains it, keep the event anyway
+        std::lock_guard<std::mutex> guard(overflowLock);
+        overflow.push_back(event);
+        overflows.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ModuleEventQueue::Drain(std::array<std::vector<ModuleEvent>, MODULE_HOOK_COUNT>& batches)
+    {
+        const uint32 count = std::min(ringCount.load(std::memory_order_acquire), MODULE_EVENT_MAX_RINGS);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            // Null while the thread that got the slot is still creating its ring
+            Ring* ring = rings[i].load(std::memory_order_acquire);
+            if (!ring)
+            {
+                continue;
+            }
+
+            const uint32 head = ring->head.load(std::memory_order_relaxed);
+            const uint32 tail = ring->tail.load(std::memory_order_acquire);
+            for (uint32 position = head; position != tail; ++position)
+            {
+                const ModuleEvent& event = ring->events[position & (MODULE_EVENT_RING_SIZE - 1)];
+                batches[static_cast<size_t>(event.hook)].push_back(event);
+            }
+
+            ring->head.store(tail, std::memory_order_release);
+        }
+
+        std::lock_guard<std::mutex> guard(overflowLock);
+        for (const ModuleEvent& event : overflow)
+        {
+            batches[static_cast<size_t>(event.hook)].push_back(event);
+        }
+
+        overflow.clear();
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef CMANGOS_MODULE_EVENT_H
+#define CMANGOS_MODULE_EVENT_H
+
+#include "Platform/Define.h"
+#include "ModuleHook.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+class WorldObject;
+
+namespace cmangos_module
+{
+    // Events buffered per producer thread before the world thread drains them (power of two)
+    constexpr uint32 MODULE_EVENT_RING_SIZE = 4096;
+    // Threads with their own event ring, any other thread goes through the locked overflow list
+    constexpr uint32 MODULE_EVENT_MAX_RINGS = 64;
+
+    // Compact copy of a notification hook call delivered later to the modules that deferred
+    // the hook (see Module::RegisterDeferredHook). Objects are referenced by their raw guid
+    // since they may no longer exist when the event gets delivered
+    struct ModuleEvent
+    {
+        // Unit that dealt the damage/heal/kill or player that got the xp, money or score
+        uint64 source;
+        // Victim of the damage/heal/kill or xp, 0 if none
+        uint64 target;
+        // Damage, heal gain, xp, money diff or score value
+        int64 amount;
+        // Victim health (OnDealDamage), added health (OnDealHeal) or score type (OnUpdatePlayerScore)
+        uint32 extra;
+        uint32 mapId;
+        uint32 instanceId;
+        ModuleHook hook;
+    };
+
+    ModuleEvent CreateModuleEvent(ModuleHook hook, const WorldObject* source, const WorldObject* target, int64 amount, uint32 extra = 0);
+
+    // Hooks that can be deferred, the ones that only notify the modules about something
+    bool IsModuleEventHook(ModuleHook hook);
+
+    // Multiple producer queue made of one single producer ring per thread, so pushing from
+    // the map update threads never takes a lock. Only the world thread drains it
+    class ModuleEventQueue
+    {
+    public:
+        ModuleEventQueue();
+        ~ModuleEventQueue();
+
+        ModuleEventQueue(const ModuleEventQueue&) = delete;
+        ModuleEventQueue& operator=(const ModuleEventQueue&) = delete;
+
+        void Push(const ModuleEvent& event);
+
+        // Appends the queued events into the batch of their hook. The events pushed by the
+        // same thread keep their order (unless its ring overflowed), there is no order between threads
+        void Drain(std::array<std::vector<ModuleEvent>, MODULE_HOOK_COUNT>& batches);
+
+        // Events that didn't fit into the ring of their thread
+        uint64 GetOverflows() const { return overflows.load(std::memory_order_relaxed); }
+
+    private:
+        struct Ring
+        {
+            std::array<ModuleEvent, MODULE_EVENT_RING_SIZE> events;
+            // Written by the world thread when draining
+            alignas(64) std::atomic<uint32> head;
+            // Written by the producer thread
+            alignas(64) std::atomic<uint32> tail;
+        };
+
+        Ring* GetThreadRing();
+        void PushOverflow(const ModuleEvent& event);
+
+    private:
+        std::array<std::atomic<Ring*>, MODULE_EVENT_MAX_RINGS> rings;
+        std::atomic<uint32> ringCount;
+
+        std::mutex overflowLock;
+        std::vector<ModuleEvent> overflow;
+        std::atomic<uint64> overflows;
+    };
+}
+
+#endif
@@ -0,0 +1,17 @@
+#include "ModuleHook.h"
+
+namespace cmangos_module
+{
+    const char* GetModuleHookName(ModuleHook hook)
+    {
+        static const char* const hookNames[] =
+        {
+#define MODULE_HOOK(name, kind, thread, hotness) #name,
+#include "ModuleHookList.h"
+#undef MODULE_HOOK
+        };
+
+        const size_t index = static_cast<size_t>(hook);
+        return index < MODULE_HOOK_COUNT ? hookNames[index] : "Unknown";
+    }
+}
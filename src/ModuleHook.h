@@ -0,0 +1,77 @@
+#ifndef CMANGOS_MODULE_HOOK_H
+#define CMANGOS_MODULE_HOOK_H
+
+#include "Platform/Define.h"
+
+namespace cmangos_module
+{
+    // How the modules take part in a hook, which decides how ModuleMgr dispatches it
+    enum class ModuleHookKind : uint8
+    {
+        // Every module gets told about something that happened
+        Notify,
+        // Modules get called until one returns true, which replaces the default logic
+        Override,
+        // Every module gets called and may change the values passed by reference, in dispatch order
+        OutParam
+    };
+
+    // Thread a hook gets called from
+    enum class ModuleHookThread : uint8
+    {
+        // World update thread, never runs concurrently with the map updates
+        World,
+        // Map update threads. Hooks of different maps run concurrently with each other,
+        // the ones of the same map (and its players) don't
+        Map
+    };
+
+    // How often a hook gets called on a populated realm
+    enum class ModuleHookHotness : uint8
+    {
+        // Logins, saves, world and social events
+        Cold,
+        // Player actions and world ticks
+        Warm,
+        // Combat rolls, spells, regeneration, called many times per map update
+        Hot
+    };
+
+    // Identifies every hook that ModuleMgr dispatches to the modules (see ModuleHookList.h)
+    enum class ModuleHook : uint8
+    {
+#define MODULE_HOOK(name, kind, thread, hotness) name,
+#include "ModuleHookList.h"
+#undef MODULE_HOOK
+        MAX
+    };
+
+    constexpr size_t MODULE_HOOK_COUNT = static_cast<size_t>(ModuleHook::MAX);
+
+    namespace detail
+    {
+        struct ModuleHookInfo
+        {
+            ModuleHookKind kind;
+            ModuleHookThread thread;
+            ModuleHookHotness hotness;
+        };
+
+        inline constexpr ModuleHookInfo moduleHookInfos[] =
+        {
+#define MODULE_HOOK(name, kind, thread, hotness) { ModuleHookKind::kind, ModuleHookThread::thread, ModuleHookHotness::hotness },
+#include "ModuleHookList.h"
+#undef MODULE_HOOK
+        };
+
+        static_assert(sizeof(moduleHookInfos) / sizeof(moduleHookInfos[0]) == MODULE_HOOK_COUNT, "Hook info table out of sync with ModuleHook");
+    }
+
+    const char* GetModuleHookName(ModuleHook hook);
+
+    constexpr ModuleHookKind GetModuleHookKind(ModuleHook hook) { return detail::moduleHookInfos[static_cast<size_t>(hook)].kind; }
+    constexpr ModuleHookThread GetModuleHookThread(ModuleHook hook) { return detail::moduleHookInfos[static_cast<size_t>(hook)].thread; }
+    constexpr ModuleHookHotness GetModuleHookHotness(ModuleHook hook) { return detail::moduleHookInfos[static_cast<size_t>(hook)].hotness; }
+}
+
+#endif
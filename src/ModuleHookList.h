@@ -0,0 +1,156 @@
+// Definition of every hook that ModuleMgr dispatches to the modules, the ModuleHook enum
+// and the hook properties are generated from it. Include it after defining
+// MODULE_HOOK(name, kind, thread, hotness), see ModuleHookKind, ModuleHookThread and
+// ModuleHookHotness (ModuleHook.h). Overloads of the same virtual that ModuleMgr
+// dispatches from a single method share a hook
+
+// Module Hooks
+MODULE_HOOK(OnUpdate, Notify, World, Warm)
+
+// World Hooks
+MODULE_HOOK(OnWorldUpdated, Notify, World, Warm)
+
+// Player Item Hooks
+MODULE_HOOK(OnUseItem, Override, Map, Warm)
+MODULE_HOOK(OnSetVisibleItemSlot, Notify, Map, Warm)
+MODULE_HOOK(OnMoveItemFromInventory, Notify, Map, Warm)
+MODULE_HOOK(OnMoveItemToInventory, Notify, Map, Warm)
+MODULE_HOOK(OnStoreLootItem, Notify, Map, Warm)
+MODULE_HOOK(OnStoreItem, Notify, Map, Warm)
+MODULE_HOOK(OnEquipItem, Notify, Map, Warm)
+MODULE_HOOK(OnSellItem, Notify, Map, Warm)
+MODULE_HOOK(OnBuyBackItem, Notify, Map, Warm)
+MODULE_HOOK(OnCreateItem, Notify, Map, Warm)
+MODULE_HOOK(OnDestroyItem, Notify, Map, Warm)
+
+// Player Gossip Hooks
+MODULE_HOOK(OnPreGossipHello, Override, Map, Warm)
+MODULE_HOOK(OnGossipHello, Notify, Map, Warm)
+MODULE_HOOK(OnGossipSelect, Override, Map, Warm)
+MODULE_HOOK(OnGossipQuestDetails, Notify, Map, Warm)
+MODULE_HOOK(OnGossipQuestReward, Notify, Map, Warm)
+
+// Player Talent Hooks
+MODULE_HOOK(OnLearnTalent, Notify, Map, Cold)
+MODULE_HOOK(OnResetTalents, Notify, Map, Cold)
+
+// Player DB Hooks
+MODULE_HOOK(OnPreLoadFromDB, Notify, World, Cold)
+MODULE_HOOK(OnLoadFromDB, Notify, World, Cold)
+MODULE_HOOK(OnSaveToDB, Notify, Map, Cold)
+MODULE_HOOK(OnDeleteFromDB, Notify, World, Cold)
+
+// Player Session Hooks
+MODULE_HOOK(OnLogOut, Notify, World, Cold)
+MODULE_HOOK(OnPreCharacterCreated, Notify, World, Cold)
+MODULE_HOOK(OnCharacterCreated, Notify, World, Cold)
+
+// Player Action Button Hooks
+MODULE_HOOK(OnLoadActionButtons, Override, Map, Cold)
+MODULE_HOOK(OnSaveActionButtons, Override, Map, Cold)
+
+// Player Action Hooks
+MODULE_HOOK(OnPreHandleFall, Override, Map, Warm)
+MODULE_HOOK(OnHandleFall, Notify, Map, Warm)
+MODULE_HOOK(OnPreResurrect, Override, Map, Warm)
+MODULE_HOOK(OnResurrect, Notify, Map, Warm)
+MODULE_HOOK(OnReleaseSpirit, Notify, Map, Warm)
+MODULE_HOOK(OnDeath, Notify, Map, Warm)
+MODULE_HOOK(OnEnvironmentalDeath, Notify, Map, Warm)
+MODULE_HOOK(OnPreGiveXP, Override, Map, Warm)
+MODULE_HOOK(OnGiveXP, Notify, Map, Warm)
+MODULE_HOOK(OnGiveLevel, Notify, Map, Warm)
+MODULE_HOOK(OnModifyMoney, Notify, Map, Warm)
+MODULE_HOOK(OnSetReputation, Notify, Map, Warm)
+MODULE_HOOK(OnGetPlayerClassLevelInfo, OutParam, Map, Warm)
+MODULE_HOOK(OnGetPlayerLevelInfo, OutParam, Map, Warm)
+MODULE_HOOK(OnUpdateSkill, Notify, Map, Warm)
+MODULE_HOOK(OnRewardHonor, Notify, Map, Warm)
+MODULE_HOOK(OnDuelComplete, Notify, Map, Cold)
+MODULE_HOOK(OnKilledMonsterCredit, OutParam, Map, Warm)
+MODULE_HOOK(OnPreRewardPlayerAtKill, Override, Map, Warm)
+MODULE_HOOK(OnRewardPlayerAtKill, Notify, Map, Warm)
+MODULE_HOOK(OnHandlePageTextQuery, Override, Map, Cold)
+MODULE_HOOK(OnRewardQuest, Notify, Map, Warm)
+MODULE_HOOK(OnTaxiFlightRouteStart, Notify, Map, Cold)
+MODULE_HOOK(OnTaxiFlightRouteEnd, Notify, Map, Cold)
+MODULE_HOOK(OnAddSpell, Notify, Map, Warm)
+MODULE_HOOK(OnEmote, Notify, Map, Warm)
+MODULE_HOOK(OnBuyBankSlot, Notify, Map, Cold)
+MODULE_HOOK(OnSummoned, Notify, Map, Cold)
+MODULE_HOOK(OnAreaExplored, Notify, Map, Warm)
+MODULE_HOOK(OnUpdateHonor, Notify, Map, Warm)
+MODULE_HOOK(OnAcceptQuest, Notify, Map, Warm)
+MODULE_HOOK(OnAbandonQuest, Notify, Map, Warm)
+MODULE_HOOK(OnPreHandleInitializeTrade, Override, Map, Cold)
+MODULE_HOOK(OnTradeAccepted, Notify, Map, Cold)
+MODULE_HOOK(OnRegenerate, OutParam, Map, Hot)
+
+// Player Mail Hooks
+MODULE_HOOK(OnCanCheckMailBox, Override, Map, Cold)
+
+// Creature Hooks
+MODULE_HOOK(OnAddToWorld, Notify, Map, Warm)
+MODULE_HOOK(OnRespawn, Override, Map, Warm)
+MODULE_HOOK(OnRespawnRequest, Notify, Map, Cold)
+
+// Game Object Hooks
+MODULE_HOOK(OnUse, Override, Map, Warm)
+
+// Unit Hooks
+MODULE_HOOK(OnCalculateEffectiveDodgeChance, Override, Map, Hot)
+MODULE_HOOK(OnCalculateEffectiveBlockChance, Override, Map, Hot)
+MODULE_HOOK(OnCalculateEffectiveParryChance, Override, Map, Hot)
+MODULE_HOOK(OnCalculateEffectiveCritChance, Override, Map, Hot)
+MODULE_HOOK(OnCalculateEffectiveMissChance, Override, Map, Hot)
+MODULE_HOOK(OnCalculateAttackTable, OutParam, Map, Hot)
+MODULE_HOOK(OnCalculateSpellMissChance, Override, Map, Hot)
+MODULE_HOOK(OnGetAttackDistance, Override, Map, Hot)
+MODULE_HOOK(OnDealDamage, Notify, Map, Hot)
+MODULE_HOOK(OnKill, Notify, Map, Warm)
+MODULE_HOOK(OnDealHeal, Notify, Map, Hot)
+MODULE_HOOK(OnSetPower, OutParam, Map, Hot)
+MODULE_HOOK(OnGetReactionTo, Override, Map, Hot)
+MODULE_HOOK(OnGetSpellRank, Override, Map, Hot)
+
+// Spell Hooks
+MODULE_HOOK(OnHit, Notify, Map, Hot)
+MODULE_HOOK(OnCast, Notify, Map, Hot)
+MODULE_HOOK(OnProc, OutParam, Map, Hot)
+MODULE_HOOK(OnPeriodicTick, Override, Map, Hot)
+
+// Loot Hooks
+MODULE_HOOK(OnFillLoot, Override, Map, Warm)
+MODULE_HOOK(OnGenerateMoneyLoot, Override, Map, Warm)
+MODULE_HOOK(OnAddItem, Notify, Map, Warm)
+MODULE_HOOK(OnSendGold, Notify, Map, Warm)
+MODULE_HOOK(OnHandleLootMasterGive, Notify, Map, Warm)
+MODULE_HOOK(OnPlayerRoll, Notify, Map, Warm)
+MODULE_HOOK(OnPlayerWinRoll, Notify, Map, Warm)
+
+// Battleground Hooks
+MODULE_HOOK(OnStartBattleGround, Notify, Map, Cold)
+MODULE_HOOK(OnEndBattleGround, Notify, Map, Cold)
+MODULE_HOOK(OnUpdatePlayerScore, Notify, Map, Warm)
+MODULE_HOOK(OnLeaveBattleGround, Notify, Map, Cold)
+MODULE_HOOK(OnJoinBattleGround, Notify, Map, Cold)
+MODULE_HOOK(OnPickUpFlag, Notify, Map, Warm)
+
+// Group Hooks
+MODULE_HOOK(OnAddMember, Notify, Map, Cold)
+MODULE_HOOK(OnRemoveMember, Notify, Map, Cold)
+MODULE_HOOK(OnPreInviteMember, Override, Map, Cold)
+
+// Auction House Hooks
+MODULE_HOOK(OnSellAuctionItem, Notify, World, Cold)
+MODULE_HOOK(OnUpdateBid, Notify, World, Cold)
+MODULE_HOOK(OnActionBidWinning, Notify, World, Cold)
+
+// Mail Hooks
+MODULE_HOOK(OnSendMail, Notify, Map, Cold)
+MODULE_HOOK(OnMailTakeItem, Notify, Map, Cold)
+MODULE_HOOK(OnMailTakeMoney, Notify, Map, Cold)
+
+// Player Dump Hooks
+MODULE_HOOK(OnWriteDump, OutParam, World, Cold)
+MODULE_HOOK(IsModuleDumpTable, Override, World, Cold)
@@ -0,0 +1,201 @@
+#include "ModuleInventoryIndex.h"
+#include "ModuleItemVisitor.h"
+
+#include "Chat/Chat.h"
+#include "Log/Log.h"
+
+namespace cmangos_module
+{
+    namespace
+    {
+        // Visits every item of the player including the bags themselves
+        template<typename Visitor>
+        void VisitAllItems(const Player* player, Visitor&& visitor)
+        {
+            helper::VisitItems(player, visitor);
+            helper::VisitItemSlots(player, INVENTORY_SLOT_BAG_START, INVENTORY_SLOT_BAG_END, visitor);
+            helper::VisitItemSlots(player, BANK_SLOT_BAG_START, BANK_SLOT_BAG_END, visitor);
+        }
+    }
+
+    void ModuleInventoryIndex::Build(const Player* player)
+    {
+        this->player = player;
+        items.clear();
+        entries.clear();
+        if (player)
+        {
+            VisitAllItems(player, [this](Item* item) { AddItem(item); });
+        }
+    }
+
+    void ModuleInventoryIndex::AddItem(const Item* item)
+    {
+        if (item && items.emplace(item->GetObjectGuid().GetRawValue(), item->GetEntry()).second)
+        {
+            ++entries[item->GetEntry()];
+        }
+    }
+
+    void ModuleInventoryIndex::RemoveItem(const Item* item)
+    {
+        if (item)
+        {
+            auto itemIt = items.find(item->GetObjectGuid().GetRawValue());
+            if (itemIt != items.end())
+            {
+                auto entryIt = entries.find(itemIt->second);
+                if (entryIt != entries.end() && --entryIt->second == 0)
+                {
+                    entries.erase(entryIt);
+                }
+
+                items.erase(itemIt);
+            }
+        }
+    }
+
+    uint32 ModuleInventoryIndex::GetItemCount(uint32 entry) const
+    {
+        auto entryIt = entries.find(entry);
+        return entryIt != entries.end() ? entryIt->second : 0;
+    }
+
+    uint32 ModuleInventoryIndex::Verify() const
+    {
+        uint32 mismatches = 0;
+        if (player)
+        {
+            const uint32 playerId = player->GetObjectGuid().GetCounter();
+            std::unordered_set<uint64> scanned;
+            VisitAllItems(player, [&](Item* item)
+            {
+                const uint64 guid = item->GetObjectGuid().GetRawValue();
+                scanned.insert(guid);
+
+                auto itemIt = items.find(guid);
+                if (itemIt == items.end() || itemIt->second != item->GetEntry())
+                {
+                    sLog.outError("Module inventory index: player %u item %llu (entry %u) is missing from the index", playerId, (unsigned long long)guid, item->GetEntry());
+                    ++mismatches;
+                }
+            });
+
+            for (const auto& itemPair : items)
+            {
+                if (scanned.find(itemPair.first) == scanned.end())
+                {
+                    sLog.outError("Module inventory index: player %u item %llu (entry %u) is indexed but not owned", playerId, (unsigned long long)itemPair.first, itemPair.second);
+                    ++mismatches;
+                }
+            }
+        }
+
+        return mismatches;
+    }
+
+    bool ModuleInventoryIndexMgr::Enable(ModulePlayerStates& states)
+    {
+        if (!enabled)
+        {
+            uint32 offset = 0;
+            if (!states.AddSlot(sizeof(ModuleInventoryIndex), alignof(ModuleInventoryIndex), [](void* data) { new (data) ModuleInventoryIndex(); }, [](void* data) { static_cast<ModuleInventoryIndex*>(data)->~ModuleInventoryIndex(); }, offset))
+            {
+                return false;
+            }
+
+            slot = ModulePlayerSlot<ModuleInventoryIndex>(&states, offset);
+            enabled = true;
+        }
+
+        return true;
+    }
+
+    void ModuleInventoryIndexMgr::OnLoad(const Player* player)
+    {
+        if (ModuleInventoryIndex* index = FindIndex(player))
+        {
+            index->Build(player);
+
+            std::lock_guard<std::mutex> guard(lock);
+            indexes.insert(index);
+        }
+    }
+
+    void ModuleInventoryIndexMgr::OnLogOut(const Player* player)
+    {
+        if (ModuleInventoryIndex* index = FindIndex(player))
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            indexes.erase(index);
+        }
+    }
+
+    void ModuleInventoryIndexMgr::OnAddItem(const Player* player, const Item* item)
+    {
+        if (ModuleInventoryIndex* index = FindIndex(player))
+        {
+            index->AddItem(item);
+            if (verify)
+            {
+                index->Verify();
+            }
+        }
+    }
+
+    void ModuleInventoryIndexMgr::OnRemoveItem(const Player* player, const Item* item)
+    {
+        if (ModuleInventoryIndex* index = FindIndex(player))
+        {
+            index->RemoveItem(item);
+            if (verify)
+            {
+                index->Verify();
+            }
+        }
+    }
+
+    const ModuleInventoryIndex* ModuleInventoryIndexMgr::GetIndex(const Player* player) const
+    {
+        return FindIndex(player);
+    }
+
+    ModuleInventoryIndex* ModuleInventoryIndexMgr::FindIndex(const Player* player) const
+    {
+        return enabled ? slot.Get(player) : nullptr;
+    }
+
+    void ModuleInventoryIndexMgr::VerifyAll(ChatHandler* chatHandler)
+    {
+        if (!enabled)
+        {
+            chatHandler->SendSysMessage("Module inventory index is not used by any module");
+            return;
+        }
+
+        // The indexes belong to the map threads, the command may run while they update their players
+        verifyAll = true;
+        chatHandler->SendSysMessage("Module inventory index: the players will be verified on the next world update (see the log for the result)");
+    }
+
+    void ModuleInventoryIndexMgr::Update()
+    {
+        if (!verifyAll.exchange(false))
+        {
+            return;
+        }
+
+        uint32 players = 0;
+        uint32 mismatches = 0;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            for (const ModuleInventoryIndex* index : indexes)
+            {
+                mismatches += index->Verify();
+                ++players;
+            }
+        }
+
+        sLog.outString("Module inventory index: verified %u players, %u mismatches", players, mismatches);
+    }
+}
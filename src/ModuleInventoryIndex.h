@@ -0,0 +1,94 @@
+#ifndef CMANGOS_MODULE_INVENTORY_INDEX_H
+#define CMANGOS_MODULE_INVENTORY_INDEX_H
+
+#include "Platform/Define.h"
+#include "ModulePlayerState.h"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+class ChatHandler;
+class Item;
+class Player;
+
+namespace cmangos_module
+{
+    // Items owned by a player (equipment, bags, keyring and bank) indexed by guid and entry.
+    // It gets built on login and then kept up to date from the item hooks. A stack that gets merged
+    // into another one when moving it isn't reported by the core, so it stays indexed until the next
+    // login: HasItem is still right (the stack it went into has the same entry) but GetItemCount and
+    // HasItemGuid may count it
+    class ModuleInventoryIndex
+    {
+    public:
+        ModuleInventoryIndex() : player(nullptr) {}
+
+        void Build(const Player* player);
+        void AddItem(const Item* item);
+        void RemoveItem(const Item* item);
+
+        bool HasItem(uint32 entry) const { return entries.find(entry) != entries.end(); }
+        bool HasItemGuid(uint64 guid) const { return items.find(guid) != items.end(); }
+        // Number of items (not stack sizes) of the given entry
+        uint32 GetItemCount(uint32 entry) const;
+        uint32 GetSize() const { return static_cast<uint32>(items.size()); }
+
+        // Cross checks the index against a full scan of the player items. Returns the amount
+        // of mismatches found, which get logged
+        uint32 Verify() const;
+
+    private:
+        const Player* player;
+        // Item guid -> entry
+        std::unordered_map<uint64, uint32> items;
+        // Entry -> item count
+        std::unordered_map<uint32, uint32> entries;
+    };
+
+    // Keeps the inventory index of the online players while any module uses it. The indexes live in
+    // a player state slot, so the item hooks reach them without a lookup or a lock
+    class ModuleInventoryIndexMgr
+    {
+    public:
+        ModuleInventoryIndexMgr() : enabled(false), verify(false), verifyAll(false) {}
+
+        // Adds the index slot to the player states. Returns false once a player has been loaded
+        bool Enable(ModulePlayerStates& states);
+        bool IsEnabled() const { return enabled; }
+
+        // Debug mode that verifies the index of the player after every change
+        void SetVerify(bool verify) { this->verify = verify; }
+        bool IsVerifying() const { return verify; }
+
+        void OnLoad(const Player* player);
+        void OnLogOut(const Player* player);
+        void OnAddItem(const Player* player, const Item* item);
+        void OnRemoveItem(const Player* player, const Item* item);
+
+        const ModuleInventoryIndex* GetIndex(const Player* player) const;
+
+        // Requests the verification of the index of every online player (see Update)
+        void VerifyAll(ChatHandler* chatHandler);
+
+        // Called from the world update once the maps got updated, so the indexes can be verified
+        // while no map thread is changing them. The result gets logged
+        void Update();
+
+    private:
+        ModuleInventoryIndex* FindIndex(const Player* player) const;
+
+    private:
+        ModulePlayerSlot<ModuleInventoryIndex> slot;
+        // The indexes are only modified from the thread that updates their player. The set of
+        // indexes is only used to verify them all, the lock protects it on login and logout
+        std::mutex lock;
+        std::unordered_set<const ModuleInventoryIndex*> indexes;
+        bool enabled;
+        std::atomic<bool> verify;
+        std::atomic<bool> verifyAll;
+    };
+}
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef CMANGOS_MODULE_ITEM_VISITOR_H
+#define CMANGOS_MODULE_ITEM_VISITOR_H
+
+#include "Entities/Player.h"
+
+#include <type_traits>
+#include <utility>
+
+namespace cmangos_module
+{
+    namespace helper
+    {
+        // Item visitors that get inlined into the caller. The visitor can either return void
+        // or bool, in which case returning false stops the iteration. The Visit functions
+        // return false if the iteration was stopped early, e.g.
+        // VisitBankItems(player, [&](Item* item) { found = item->GetEntry() == entry; return !found; });
+        template<typename Visitor>
+        inline bool VisitItem(Item* item, Visitor& visitor)
+        {
+            if constexpr (std::is_void_v<decltype(visitor(item))>)
+            {
+                visitor(item);
+                return true;
+            }
+            else
+            {
+                return static_cast<bool>(visitor(item));
+            }
+        }
+
+        template<typename Visitor>
+        inline bool VisitItemSlots(const Player* player, uint8 start, uint8 end, Visitor& visitor)
+        {
+            for (uint8 i = start; i < end; ++i)
+            {
+                if (Item* item = player->GetItemByPos(INVENTORY_SLOT_BAG_0, i))
+                {
+                    if (!VisitItem(item, visitor))
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        // Visits the items stored inside the bags placed on the given slots
+        template<typename Visitor>
+        inline bool VisitBagItems(const Player* player, uint8 start, uint8 end, Visitor& visitor)
+        {
+            for (uint8 i = start; i < end; ++i)
+            {
+                if (Bag* bag = (Bag*)player->GetItemByPos(INVENTORY_SLOT_BAG_0, i))
+                {
+                    for (uint32 j = 0; j < bag->GetBagSize(); ++j)
+                    {
+                        if (Item* item = bag->GetItemByPos(j))
+                        {
+                            if (!VisitItem(item, visitor))
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        template<typename Visitor>
+        inline bool VisitEquippedItems(const Player* player, Visitor&& visitor)
+        {
+            return !player || VisitItemSlots(player, EQUIPMENT_SLOT_START, EQUIPMENT_SLOT_END, visitor);
+        }
+
+        template<typename Visitor>
+        inline bool VisitInventoryItems(const Player* player, Visitor&& visitor)
+        {
+            return !player || (VisitItemSlots(player, INVENTORY_SLOT_ITEM_START, INVENTORY_SLOT_ITEM_END, visitor) &&
+                               VisitBagItems(player, INVENTORY_SLOT_BAG_START, INVENTORY_SLOT_BAG_END, visitor));
+        }
+
+        template<typename Visitor>
+        inline bool VisitKeyItems(const Player* player, Visitor&& visitor)
+        {
+            return !player || VisitItemSlots(player, KEYRING_SLOT_START, KEYRING_SLOT_END, visitor);
+        }
+
+        template<typename Visitor>
+        inline bool VisitBankItems(const Player* player, Visitor&& visitor)
+        {
+            return !player || (VisitItemSlots(player, BANK_SLOT_ITEM_START, BANK_SLOT_ITEM_END, visitor) &&
+                               VisitBagItems(player, BANK_SLOT_BAG_START, BANK_SLOT_BAG_END, visitor));
+        }
+
+        template<typename Visitor>
+        inline bool VisitItems(const Player* player, Visitor&& visitor)
+        {
+            return VisitEquippedItems(player, visitor) &&
+                   VisitInventoryItems(player, visitor) &&
+                   VisitKeyItems(player, visitor) &&
+                   VisitBankItems(player, visitor);
+        }
+
+        // Restricts a visitor to the items of the given class and minimum quality, e.g.
+        // VisitBankItems(player, FilterItems(ItemFilter(ITEM_CLASS_ARMOR, ITEM_QUALITY_RARE), visitor))
+        struct ItemFilter
+        {
+            static constexpr uint32 ANY_CLASS = uint32(-1);
+
+            explicit ItemFilter(uint32 itemClass = ANY_CLASS, uint32 minQuality = 0) : itemClass(itemClass), minQuality(minQuality) {}
+
+            bool Matches(const Item* item) const
+            {
+                const ItemPrototype* proto = item->GetProto();
+                return proto && (itemClass == ANY_CLASS || proto->Class == itemClass) && proto->Quality >= minQuality;
+            }
+
+            uint32 itemClass;
+            uint32 minQuality;
+        };
+
+        template<typename Visitor>
+        inline auto FilterItems(const ItemFilter& filter, Visitor&& visitor)
+        {
+            return [filter, visitor = std::forward<Visitor>(visitor)](Item* item) mutable
+            {
+                return !filter.Matches(item) || VisitItem(item, visitor);
+            };
+        }
+    }
+}
+
+#endif
@@ -1,15 +1,59 @@
 #include "ModuleMgr.h"
 #include "Modules.h"
 #include "Module.h"
+#include "ModuleConfig.h"
+#include "ModuleStatic.h"
 
+#include "Chat/Chat.h"
+#include "Database/DatabaseEnv.h"
 #include "Entities/ObjectGuid.h"
 #include "Entities/Player.h"
 #include "Entities/Unit.h"
+#include "Log/Log.h"
+#include "Spells/Spell.h"
+#include "Spells/SpellAuras.h"
+
+#include <algorithm>
+#include <charconv>
 
 INSTANTIATE_SINGLETON_1(cmangos_module::ModuleMgr);
 
 namespace cmangos_module
 {
+    // World ticks an old config snapshot is kept alive after being replaced
+    constexpr uint32 MODULE_CONFIG_RETIRE_TICKS = 3;
+    // Interval between the checks of the config files when watching them (ms)
+    constexpr uint32 MODULE_CONFIG_WATCH_INTERVAL = 5 * IN_MILLISECONDS;
+
+    uint64 ModuleMgr::activeHooks[(MODULE_HOOK_COUNT + 63) / 64] = {};
+
+    template<ModuleHook hook, typename Callback>
+    void ModuleMgr::DispatchHook(Callback callback)
+    {
+        static_assert(GetModuleHookKind(hook) != ModuleHookKind::Override, "Override hooks must stop at the first module that returns true");
+        for (Module* mod : GetHookModules(hook))
+        {
+            MODULE_PROFILE_HOOK(mod, hook);
+            callback(mod);
+        }
+    }
+
+    template<ModuleHook hook, typename Callback>
+    bool ModuleMgr::DispatchOverrideHook(Callback callback)
+    {
+        static_assert(GetModuleHookKind(hook) == ModuleHookKind::Override, "Only override hooks can stop the dispatch");
+        for (Module* mod : GetHookModules(hook))
+        {
+            MODULE_PROFILE_HOOK(mod, hook);
+            if (callback(mod))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     ModuleMgr::~ModuleMgr()
     {
         for (Module* mod : modules)
@@ -19,22 +63,403 @@ namespace cmangos_module
         }
 
         modules.clear();
+
+        for (std::vector<Module*>& subscribers : hookModules)
+        {
+            subscribers.clear();
+        }
+
+        for (std::vector<Module*>& subscribers : deferredHookModules)
+        {
+            subscribers.clear();
+        }
+
+        std::fill(std::begin(activeHooks), std::end(activeHooks), 0);
+
+        for (RetiredConfig& retiredConfig : retiredConfigs)
+        {
+            delete retiredConfig.config;
+        }
+
+        retiredConfigs.clear();
     }
 
     void ModuleMgr::RegisterModule(Module* mod)
     {
+        mod->id = static_cast<uint32>(modules.size());
         modules.push_back(mod);
     }
 
+    uint32 ModuleMgr::RegisterTask(const Module* mod, const std::string& taskName, uint32 interval, ModuleTaskCost cost, ModuleTaskCallback callback)
+    {
+        return scheduler.AddTask(mod, taskName, interval, cost, std::move(callback));
+    }
+
+    void ModuleMgr::RemoveTask(uint32 taskId)
+    {
+        scheduler.RemoveTask(taskId);
+    }
+
+    uint32 ModuleMgr::RegisterCharacterQuery(const Module* mod, const std::string& query)
+    {
+        ModuleCharacterQuery characterQuery(mod->GetId(), query);
+        if (!characterQuery.IsValid())
+        {
+            sLog.outError("Module %s: character query '%s' must contain a single %%u for the character guid", mod->GetName().c_str(), query.c_str());
+        }
+
+        // The query id is the index within the queries of the module
+        const uint32 queryId = static_cast<uint32>(std::count_if(characterQueries.begin(), characterQueries.end(), [mod](const ModuleCharacterQuery& registered)
+        {
+            return registered.GetModuleId() == mod->GetId();
+        }));
+
+        characterQueries.push_back(std::move(characterQuery));
+        return queryId;
+    }
+
+    const ModulePlayerStates* ModuleMgr::RegisterPlayerState(const Module* mod, uint32 size, uint32 alignment, ModulePlayerStates::Constructor constructor, ModulePlayerStates::Destructor destructor, uint32& outOffset)
+    {
+        if (!playerStates.AddSlot(size, alignment, constructor, destructor, outOffset))
+        {
+            sLog.outError("Module %s: player states must be registered before the first player loads", mod->GetName().c_str());
+            return nullptr;
+        }
+
+        return &playerStates;
+    }
+
+    void ModuleMgr::RegisterCreatureState(ModuleCreatureStateBase* state)
+    {
+        creatureStates.push_back(state);
+
+        // The states get reset from OnAddToWorld, also when created after the hooks got built
+        const size_t index = static_cast<size_t>(ModuleHook::OnAddToWorld);
+        activeHooks[index / 64] |= uint64(1) << (index % 64);
+    }
+
+    void ModuleMgr::UnregisterCreatureState(ModuleCreatureStateBase* state)
+    {
+        creatureStates.erase(std::remove(creatureStates.begin(), creatureStates.end(), state), creatureStates.end());
+    }
+
+    bool ModuleMgr::OnInitializeLoginQueryHolder(SqlQueryHolder* holder, uint32 playerId)
+    {
+        if (!holder || characterQueries.empty())
+        {
+            return true;
+        }
+
+        bool result = true;
+        holder->SetSize(MAX_PLAYER_LOGIN_QUERY + characterQueries.size());
+        for (size_t i = 0; i < characterQueries.size(); ++i)
+        {
+            // Invalid queries keep their slot empty so the query ids of the module don't shift
+            const ModuleCharacterQuery& characterQuery = characterQueries[i];
+            if (characterQuery.IsValid())
+            {
+                result &= holder->SetQuery(MAX_PLAYER_LOGIN_QUERY + i, characterQuery.Format(playerId).c_str());
+            }
+        }
+
+        return result;
+    }
+
+    void ModuleMgr::RetireConfig(ModuleConfig* config)
+    {
+        if (config)
+        {
+            {
+                std::lock_guard<std::mutex> guard(retiredConfigsLock);
+                retiredConfigs.push_back({ config, 0 });
+            }
+
+            // The memoized chances may come from the old config
+            chanceCache.InvalidateAll();
+        }
+    }
+
+    void ModuleMgr::UpdateRetiredConfigs()
+    {
+        std::lock_guard<std::mutex> guard(retiredConfigsLock);
+        if (!retiredConfigs.empty())
+        {
+            // By then no map update can still be reading the old snapshot
+            retiredConfigs.erase(std::remove_if(retiredConfigs.begin(), retiredConfigs.end(), [](RetiredConfig& retiredConfig)
+            {
+                if (++retiredConfig.ticks < MODULE_CONFIG_RETIRE_TICKS)
+                {
+                    return false;
+                }
+
+                delete retiredConfig.config;
+                return true;
+            }), retiredConfigs.end());
+        }
+    }
+
+    uint32 ModuleMgr::ReloadConfigs(std::string_view moduleName)
+    {
+        uint32 reloaded = 0;
+        for (Module* mod : modules)
+        {
+            if ((moduleName.empty() || mod->GetName() == moduleName) && mod->ReloadConfig())
+            {
+                ++reloaded;
+            }
+        }
+
+        return reloaded;
+    }
+
+    void ModuleMgr::SetConfigWatch(bool enabled)
+    {
+        if (enabled && !configWatchTask)
+        {
+            configFileTimes.assign(modules.size(), std::filesystem::file_time_type());
+            CheckConfigFiles();
+            configWatchTask = scheduler.AddTask(nullptr, "ConfigWatch", MODULE_CONFIG_WATCH_INTERVAL, ModuleTaskCost::Light, [this](uint32)
+            {
+                CheckConfigFiles();
+            });
+        }
+        else if (!enabled && configWatchTask)
+        {
+            scheduler.RemoveTask(configWatchTask);
+            configWatchTask = 0;
+        }
+    }
+
+    void ModuleMgr::CheckConfigFiles()
+    {
+        for (Module* mod : modules)
+        {
+            const ModuleConfig* config = mod->GetConfig();
+            if (config)
+            {
+                std::error_code error;
+                const std::filesystem::file_time_type fileTime = std::filesystem::last_write_time(config->GetFilePath(), error);
+                if (!error)
+                {
+                    // The first check only records the current time of the files
+                    std::filesystem::file_time_type& lastFileTime = configFileTimes[mod->GetId()];
+                    if (lastFileTime != std::filesystem::file_time_type() && fileTime != lastFileTime)
+                    {
+                        mod->ReloadConfig();
+                    }
+
+                    lastFileTime = fileTime;
+                }
+            }
+        }
+    }
+
+    void ModuleMgr::EnableInventoryIndex()
+    {
+        if (!inventoryIndex.Enable(playerStates))
+        {
+            sLog.outError("Module inventory index must be enabled before the first player loads");
+        }
+    }
+
+    bool ModuleMgr::IsInventoryIndexHook(ModuleHook hook)
+    {
+        switch (hook)
+        {
+            case ModuleHook::OnLoadFromDB:
+            case ModuleHook::OnLogOut:
+            case ModuleHook::OnStoreItem:
+            case ModuleHook::OnStoreLootItem:
+            case ModuleHook::OnEquipItem:
+            case ModuleHook::OnMoveItemToInventory:
+            case ModuleHook::OnMoveItemFromInventory:
+            case ModuleHook::OnSellItem:
+            case ModuleHook::OnBuyBackItem:
+            case ModuleHook::OnCreateItem:
+            case ModuleHook::OnDestroyItem:
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    bool ModuleMgr::IsAttackTableHook(ModuleHook hook)
+    {
+        switch (hook)
+        {
+            case ModuleHook::OnCalculateEffectiveMissChance:
+            case ModuleHook::OnCalculateEffectiveDodgeChance:
+            case ModuleHook::OnCalculateEffectiveParryChance:
+            case ModuleHook::OnCalculateEffectiveBlockChance:
+            case ModuleHook::OnCalculateEffectiveCritChance:
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    size_t ModuleMgr::GetSpellHookIndex(ModuleHook hook)
+    {
+        switch (hook)
+        {
+            case ModuleHook::OnCast: return 0;
+            case ModuleHook::OnHit: return 1;
+            case ModuleHook::OnProc: return 2;
+            default: return 3;
+        }
+    }
+
+    size_t ModuleMgr::GetCreatureHookIndex(ModuleHook hook)
+    {
+        switch (hook)
+        {
+            case ModuleHook::OnAddToWorld: return 0;
+            case ModuleHook::OnRespawn: return 1;
+            default: return 2;
+        }
+    }
+
+    void ModuleMgr::BuildHookModules()
+    {
+        // The attack table is read through the single chance hooks called by the core
+        const bool attackTableActive = std::any_of(modules.begin(), modules.end(), [](const Module* mod)
+        {
+            return mod->HasHook(ModuleHook::OnCalculateAttackTable);
+        });
+
+        if (staticHooks)
+        {
+            staticHooks->Subscribe();
+        }
+
+        for (size_t i = 0; i < MODULE_HOOK_COUNT; ++i)
+        {
+            const ModuleHook hook = static_cast<ModuleHook>(i);
+            std::vector<Module*>& subscribers = hookModules[i];
+            subscribers.clear();
+
+            for (Module* mod : modules)
+            {
+                if (mod->HasHook(hook))
+                {
+                    subscribers.push_back(mod);
+                }
+            }
+
+            // Higher priorities first, modules with the same priority keep the registration order
+            std::stable_sort(subscribers.begin(), subscribers.end(), [hook](const Module* a, const Module* b)
+            {
+                return a->GetHookPriority(hook) > b->GetHookPriority(hook);
+            });
+
+            subscribers.shrink_to_fit();
+
+            if (IsModuleSpellHook(hook))
+            {
+                SpellHookModules& spellSubscribers = spellHookModules[GetSpellHookIndex(hook)];
+                spellSubscribers = SpellHookModules();
+                for (Module* mod : subscribers)
+                {
+                    const ModuleSpellFilter* filter = mod->GetSpellFilter(hook);
+                    if (filter)
+                    {
+                        spellSubscribers.filter.Merge(*filter);
+                    }
+                    else
+                    {
+                        spellSubscribers.unfiltered.push_back(mod);
+                    }
+
+                    spellSubscribers.subscribers.emplace_back(mod, filter);
+                }
+            }
+
+            if (IsModuleCreatureHook(hook))
+            {
+                CreatureHookModules& creatureSubscribers = creatureHookModules[GetCreatureHookIndex(hook)];
+                creatureSubscribers = CreatureHookModules();
+                for (Module* mod : subscribers)
+                {
+                    const ModuleCreatureFilter* filter = mod->GetCreatureFilter(hook);
+                    if (filter)
+                    {
+                        creatureSubscribers.filter.Merge(*filter);
+                    }
+                    else
+                    {
+                        creatureSubscribers.unfiltered.push_back(mod);
+                    }
+
+                    creatureSubscribers.subscribers.emplace_back(mod, filter);
+                }
+            }
+
+            std::vector<Module*>& deferredSubscribers = deferredHookModules[i];
+            deferredSubscribers.clear();
+            for (Module* mod : modules)
+            {
+                if (mod->HasDeferredHook(hook))
+                {
+                    deferredSubscribers.push_back(mod);
+                }
+            }
+
+            // The static dispatch calls the modules of the set that have the hook in the set order
+            bool implemented = true;
+            staticHookMask.reset(i);
+            if (staticHooks && IsModuleStaticHook(hook) && !subscribers.empty())
+            {
+                std::vector<Module*> staticSubscribers;
+                for (Module* mod : staticHooks->modules)
+                {
+                    if (mod->HasHook(hook))
+                    {
+                        staticSubscribers.push_back(mod);
+                    }
+                }
+
+                if (staticSubscribers == subscribers)
+                {
+                    staticHookMask.set(i);
+                    implemented = staticHooks->implemented.test(i);
+                }
+            }
+
+            const uint64 hookBit = uint64(1) << (i % 64);
+            // Hooks the module system uses itself even without subscribers
+            const bool internal = (inventoryIndex.IsEnabled() && IsInventoryIndexHook(hook)) || (attackTableActive && IsAttackTableHook(hook)) || (playerStates.HasSlots() && (hook == ModuleHook::OnLoadFromDB || hook == ModuleHook::OnLogOut)) || (!creatureStates.empty() && hook == ModuleHook::OnAddToWorld);
+            if ((subscribers.empty() || !implemented) && deferredSubscribers.empty() && !internal)
+            {
+                activeHooks[i / 64] &= ~hookBit;
+            }
+            else
+            {
+                activeHooks[i / 64] |= hookBit;
+            }
+        }
+    }
+
     void ModuleMgr::OnWorldPreInitialized()
     {
         AddModules();
 
+#ifdef MODULES_STATIC_DISPATCH
+        staticHooks = GetStaticModuleHooks(modules);
+#endif
+
         for (Module* mod : modules)
         {
             mod->LoadConfig();
             mod->OnWorldPreInitialized();
         }
+
+        BuildHookModules();
+
+#ifdef MODULES_PROFILING
+        profiler.Initialize(modules);
+#endif
     }
 
     void ModuleMgr::OnWorldInitialized()
@@ -44,29 +469,103 @@ namespace cmangos_module
             mod->Initialize();
             mod->OnWorldInitialized();
         }
+
+        // Modules may declare their hooks and commands when initializing
+        BuildHookModules();
+        BuildCommandTable();
+        LogHookOrder();
+    }
+
+    void ModuleMgr::LogHookOrder() const
+    {
+        for (size_t i = 0; i < MODULE_HOOK_COUNT; ++i)
+        {
+            // The order only matters when more than one module listens to the hook
+            const ModuleHook hook = static_cast<ModuleHook>(i);
+            const std::vector<Module*>& subscribers = hookModules[i];
+            if (subscribers.size() > 1)
+            {
+                std::string order;
+                for (const Module* mod : subscribers)
+                {
+                    helper::AppendFormat(order, "%s%s (%d)", order.empty() ? "" : ", ", mod->GetName().c_str(), mod->GetHookPriority(hook));
+                }
+
+                sLog.outString("Module hook %s dispatch order: %s", GetModuleHookName(hook), order.c_str());
+            }
+        }
+
+        // Modules that don't declare their hooks get called by the hot ones as well
+        uint32 hotHooks = 0;
+        for (size_t i = 0; i < MODULE_HOOK_COUNT; ++i)
+        {
+            if (GetModuleHookHotness(static_cast<ModuleHook>(i)) == ModuleHookHotness::Hot)
+            {
+                ++hotHooks;
+            }
+        }
+
+        for (const Module* mod : modules)
+        {
+            if (!mod->declaredHooks)
+            {
+                sLog.outString("Module %s doesn't declare its hooks and gets called by all of them, including the %u hot combat and spell hooks", mod->GetName().c_str(), hotHooks);
+            }
+        }
     }
 
     void ModuleMgr::OnWorldUpdated(uint32 elapsed)
     {
-        for (Module* mod : modules)
+        DispatchHook<ModuleHook::OnUpdate>([&](Module* mod) { mod->OnUpdate(elapsed); });
+
+        DispatchHook<ModuleHook::OnWorldUpdated>([&](Module* mod) { mod->OnWorldUpdated(elapsed); });
+
+        DispatchDeferredEvents();
+        chanceCache.Update(elapsed);
+        scheduler.Update(elapsed);
+        inventoryIndex.Update();
+
+        // Runs after the map updates, so no hook can be using the creature states
+        creatureStateSweepTimer += elapsed;
+        if (creatureStateSweepTimer >= MODULE_CREATURE_STATE_SWEEP_INTERVAL)
         {
-            mod->OnUpdate(elapsed);
-            mod->OnWorldUpdated(elapsed);
+            creatureStateSweepTimer = 0;
+            for (ModuleCreatureStateBase* state : creatureStates)
+            {
+                state->Sweep();
+            }
         }
+        UpdateRetiredConfigs();
+
+#ifdef MODULES_PROFILING
+        profiler.Update(elapsed);
+#endif
     }
 
-    bool ModuleMgr::OnUseItem(Player* player, Item* item)
+    void ModuleMgr::DispatchDeferredEvents()
     {
-        bool overriden = false;
-        for (Module* mod : modules)
+        // Runs at the end of the world update, after the map updates pushed their events
+        events.Drain(eventBatches);
+        for (size_t i = 0; i < MODULE_HOOK_COUNT; ++i)
         {
-            if (mod->OnUseItem(player, item))
+            std::vector<ModuleEvent>& batch = eventBatches[i];
+            if (!batch.empty())
             {
-                overriden = true;
+                const ModuleHook hook = static_cast<ModuleHook>(i);
+                for (Module* mod : deferredHookModules[i])
+                {
+                    MODULE_PROFILE_HOOK(mod, hook);
+                    mod->OnDeferredEvents(hook, batch);
+                }
+
+                batch.clear();
             }
         }
+    }
 
-        return overriden;
+    bool ModuleMgr::OnUseItem(Player* player, Item* item)
+    {
+        return DispatchOverrideHook<ModuleHook::OnUseItem>([&](Module* mod) { return mod->OnUseItem(player, item); });
     }
 
     bool ModuleMgr::OnPreGossipHello(Player* player, const ObjectGuid& guid)
@@ -79,13 +578,7 @@ namespace cmangos_module
                 Creature* creature = player->GetNPCIfCanInteractWith(guid, UNIT_NPC_FLAG_NONE);
                 if (creature)
                 {
-                    for (Module* mod : modules)
-                    {
-                        if (mod->OnPreGossipHello(player, creature))
-                        {
-                            overriden = true;
-                        }
-                    }
+                    overriden = DispatchOverrideHook<ModuleHook::OnPreGossipHello>([&](Module* mod) { return mod->OnPreGossipHello(player, creature); });
                 }
             }
             else if (guid.IsGameObject())
@@ -93,13 +586,7 @@ namespace cmangos_module
                 GameObject* gameObject = player->GetGameObjectIfCanInteractWith(guid);
                 if (gameObject)
                 {
-                    for (Module* mod : modules)
-                    {
-                        if (mod->OnPreGossipHello(player, gameObject))
-                        {
-                            overriden = true;
-                        }
-                    }
+                    overriden = DispatchOverrideHook<ModuleHook::OnPreGossipHello>([&](Module* mod) { return mod->OnPreGossipHello(player, gameObject); });
                 }
             }
         }
@@ -116,10 +603,7 @@ namespace cmangos_module
                 Creature* creature = player->GetNPCIfCanInteractWith(guid, UNIT_NPC_FLAG_NONE);
                 if (creature)
                 {
-                    for (Module* mod : modules)
-                    {
-                        mod->OnGossipHello(player, creature);
-                    }
+                    DispatchHook<ModuleHook::OnGossipHello>([&](Module* mod) { mod->OnGossipHello(player, creature); });
                 }
             }
             else if (guid.IsGameObject())
@@ -127,10 +611,7 @@ namespace cmangos_module
                 GameObject* gameObject = player->GetGameObjectIfCanInteractWith(guid);
                 if (gameObject)
                 {
-                    for (Module* mod : modules)
-                    {
-                        mod->OnGossipHello(player, gameObject);
-                    }
+                    DispatchHook<ModuleHook::OnGossipHello>([&](Module* mod) { mod->OnGossipHello(player, gameObject); });
                 }
             }
         }
@@ -146,13 +627,7 @@ namespace cmangos_module
                 Creature* creature = player->GetNPCIfCanInteractWith(guid, UNIT_NPC_FLAG_NONE);
                 if (creature)
                 {
-                    for (Module* mod : modules)
-                    {
-                        if (mod->OnGossipSelect(player, creature, sender, action, code, gossipListId))
-                        {
-                            overriden = true;
-                        }
-                    }
+                    overriden = DispatchOverrideHook<ModuleHook::OnGossipSelect>([&](Module* mod) { return mod->OnGossipSelect(player, creature, sender, action, code, gossipListId); });
                 }
             }
             else if (guid.IsGameObject())
@@ -160,13 +635,7 @@ namespace cmangos_module
                 GameObject* gameObject = player->GetGameObjectIfCanInteractWith(guid);
                 if (gameObject)
                 {
-                    for (Module* mod : modules)
-                    {
-                        if (mod->OnGossipSelect(player, gameObject, sender, action, code, gossipListId))
-                        {
-                            overriden = true;
-                        }
-                    }
+                    overriden = DispatchOverrideHook<ModuleHook::OnGossipSelect>([&](Module* mod) { return mod->OnGossipSelect(player, gameObject, sender, action, code, gossipListId); });
                 }
             }
             else if (guid.IsItem())
@@ -174,13 +643,7 @@ namespace cmangos_module
                 Item* item = player->GetItemByGuid(guid);
                 if (item)
                 {
-                    for (Module* mod : modules)
-                    {
-                        if (mod->OnGossipSelect(player, item, sender, action, code, gossipListId))
-                        {
-                            overriden = true;
-                        }
-                    }
+                    overriden = DispatchOverrideHook<ModuleHook::OnGossipSelect>([&](Module* mod) { return mod->OnGossipSelect(player, item, sender, action, code, gossipListId); });
                 }
             }
         }
@@ -190,34 +653,26 @@ namespace cmangos_module
 
     void ModuleMgr::OnGossipQuestDetails(Player* player, const Quest* quest, const ObjectGuid& questGiverGuid)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnGossipQuestDetails(player, quest, questGiverGuid);
-        }
+        DispatchHook<ModuleHook::OnGossipQuestDetails>([&](Module* mod) { mod->OnGossipQuestDetails(player, quest, questGiverGuid); });
     }
 
     void ModuleMgr::OnGossipQuestReward(Player* player, const Quest* quest, const ObjectGuid& questGiverGuid)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnGossipQuestReward(player, quest, questGiverGuid);
-        }
+        DispatchHook<ModuleHook::OnGossipQuestReward>([&](Module* mod) { mod->OnGossipQuestReward(player, quest, questGiverGuid); });
     }
 
     void ModuleMgr::OnLearnTalent(Player* player, uint32 spellId)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnLearnTalent(player, spellId);
-        }
+        chanceCache.Invalidate(player);
+
+        DispatchHook<ModuleHook::OnLearnTalent>([&](Module* mod) { mod->OnLearnTalent(player, spellId); });
     }
 
     void ModuleMgr::OnResetTalents(Player* player, uint32 cost)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnResetTalents(player, cost);
-        }
+        chanceCache.Invalidate(player);
+
+        DispatchHook<ModuleHook::OnResetTalents>([&](Module* mod) { mod->OnResetTalents(player, cost); });
     }
 
     void ModuleMgr::OnPreLoadFromDB(Player* player)
@@ -225,482 +680,410 @@ namespace cmangos_module
         if (player)
         {
             const uint32 playerId = player->GetObjectGuid().GetCounter();
-            for (Module* mod : modules)
+            DispatchHook<ModuleHook::OnPreLoadFromDB>([&](Module* mod)
             {
                 mod->OnPreLoadFromDB(player);
                 mod->OnPreLoadFromDB(playerId);
-            }
+            });
         }
 
     }
 
-    void ModuleMgr::OnLoadFromDB(Player* player)
+    void ModuleMgr::OnLoadFromDB(Player* player, SqlQueryHolder* holder)
     {
-        for (Module* mod : modules)
+        // Create the player states and build the inventory index (kept in them) before the modules get to use them
+        playerStates.OnLoad(player);
+        inventoryIndex.OnLoad(player);
+
+        // Hand the prefetched results over to the modules that registered them
+        std::vector<ModuleQueryResults> results(characterQueries.empty() ? 0 : modules.size());
+        if (holder)
         {
-            mod->OnLoadFromDB(player);
+            for (size_t i = 0; i < characterQueries.size(); ++i)
+            {
+                results[characterQueries[i].GetModuleId()].Add(holder->GetResult(MAX_PLAYER_LOGIN_QUERY + i));
+            }
         }
+
+        static const ModuleQueryResults emptyResults;
+        DispatchHook<ModuleHook::OnLoadFromDB>([&](Module* mod)
+        {
+            mod->OnLoadFromDB(player);
+            mod->OnLoadFromDB(player, results.empty() ? emptyResults : results[mod->GetId()]);
+        });
     }
 
     void ModuleMgr::OnSaveToDB(Player* player)
     {
-        for (Module* mod : modules)
+        ModuleTransaction& transaction = ModuleTransaction::GetThreadTransaction();
+        DispatchHook<ModuleHook::OnSaveToDB>([&](Module* mod)
         {
             mod->OnSaveToDB(player);
-        }
+            mod->OnSaveToDB(player, transaction);
+        });
+
+        transaction.Commit(CharacterDatabase);
     }
 
     void ModuleMgr::OnDeleteFromDB(uint32 playerId)
     {
-        for (Module* mod : modules)
+        ModuleTransaction& transaction = ModuleTransaction::GetThreadTransaction();
+        DispatchHook<ModuleHook::OnDeleteFromDB>([&](Module* mod)
         {
             mod->OnDeleteFromDB(playerId);
-        }
+            mod->OnDeleteFromDB(playerId, transaction);
+        });
+
+        transaction.Commit(CharacterDatabase);
     }
 
     void ModuleMgr::OnLogOut(Player* player)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnLogOut(player);
-        }
+        DispatchHook<ModuleHook::OnLogOut>([&](Module* mod) { mod->OnLogOut(player); });
+
+        inventoryIndex.OnLogOut(player);
+        playerStates.OnLogOut(player);
     }
 
     void ModuleMgr::OnPreCharacterCreated(Player* player)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnPreCharacterCreated(player);
-        }
+        DispatchHook<ModuleHook::OnPreCharacterCreated>([&](Module* mod) { mod->OnPreCharacterCreated(player); });
     }
 
     void ModuleMgr::OnCharacterCreated(Player* player)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnCharacterCreated(player);
-        }
+        DispatchHook<ModuleHook::OnCharacterCreated>([&](Module* mod) { mod->OnCharacterCreated(player); });
     }
 
     bool ModuleMgr::OnLoadActionButtons(Player* player, ActionButtonList& actionButtons)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
-        {
-            if (mod->OnLoadActionButtons(player, actionButtons))
-            {
-                overriden = true;
-            }
-        }
-
-        return overriden;
+        return DispatchOverrideHook<ModuleHook::OnLoadActionButtons>([&](Module* mod) { return mod->OnLoadActionButtons(player, actionButtons); });
     }
 
     bool ModuleMgr::OnLoadActionButtons(Player* player, ActionButtonList(&actionButtons)[2])
     {
-        bool overriden = false;
-        for (Module* mod : modules)
+        // Every list is offered to the module, the first module that overrides any of them
+        // replaces the default logic for all of them
+        return DispatchOverrideHook<ModuleHook::OnLoadActionButtons>([&](Module* mod)
         {
-            for (auto& actionButton : actionButtons)
-            {
-                if (mod->OnLoadActionButtons(player, actionButton))
-                {
-                    overriden = true;
-                }
-            }
-
-            if (overriden)
+            bool overriden = false;
+            for (ActionButtonList& actionButtonList : actionButtons)
             {
-                break;
+                overriden |= mod->OnLoadActionButtons(player, actionButtonList);
             }
-        }
 
-        return overriden;
+            return overriden;
+        });
     }
 
-    bool ModuleMgr::OnSaveActionButtons(Player* player, ActionButtonList& actionButtons)
-    {
-        bool overriden = false;
-        for (Module* mod : modules)
-        {
-            if (mod->OnSaveActionButtons(player, actionButtons))
-            {
-                overriden = true;
-            }
-        }
-
-        return overriden;
-    }
-
-    bool ModuleMgr::OnSaveActionButtons(Player* player, ActionButtonList(&actionButtons)[2])
-    {
-        bool overriden = false;
-        for (Module* mod : modules)
-        {
-            for (auto& actionButton : actionButtons)
-            {
-                if (mod->OnSaveActionButtons(player, actionButton))
-                {
-                    overriden = true;
-                }
-            }
-
-            if (overriden)
-            {
-                break;
-            }
-        }
-
-        return overriden;
+    bool ModuleMgr::OnSaveActionButtons(Player* player, ActionButtonList& actionButtons)
+    {
+        return DispatchOverrideHook<ModuleHook::OnSaveActionButtons>([&](Module* mod) { return mod->OnSaveActionButtons(player, actionButtons); });
     }
 
-    bool ModuleMgr::OnPreHandleFall(Player* player, const MovementInfo& movementInfo, float lastFallZ, uint32& outDamage)
+    bool ModuleMgr::OnSaveActionButtons(Player* player, ActionButtonList(&actionButtons)[2])
     {
-        bool overriden = false;
-        for (Module* mod : modules)
+        // Every list is offered to the module, the first module that overrides any of them
+        // replaces the default logic for all of them
+        return DispatchOverrideHook<ModuleHook::OnSaveActionButtons>([&](Module* mod)
         {
-            if (mod->OnPreHandleFall(player, movementInfo, lastFallZ, outDamage))
+            bool overriden = false;
+            for (ActionButtonList& actionButtonList : actionButtons)
             {
-                overriden = true;
+                overriden |= mod->OnSaveActionButtons(player, actionButtonList);
             }
-        }
 
-        return overriden;
+            return overriden;
+        });
+    }
+
+    bool ModuleMgr::OnPreHandleFall(Player* player, const MovementInfo& movementInfo, float lastFallZ, uint32& outDamage)
+    {
+        return DispatchOverrideHook<ModuleHook::OnPreHandleFall>([&](Module* mod) { return mod->OnPreHandleFall(player, movementInfo, lastFallZ, outDamage); });
     }
 
     void ModuleMgr::OnHandleFall(Player* player, const MovementInfo& movementInfo, float lastFallZ, uint32 damage)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnHandleFall(player, movementInfo, lastFallZ, damage);
-        }
+        DispatchHook<ModuleHook::OnHandleFall>([&](Module* mod) { mod->OnHandleFall(player, movementInfo, lastFallZ, damage); });
     }
 
     bool ModuleMgr::OnPreResurrect(Player* player)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
-        {
-            if (mod->OnPreResurrect(player))
-            {
-                overriden = true;
-            }
-        }
-
-        return overriden;
+        return DispatchOverrideHook<ModuleHook::OnPreResurrect>([&](Module* mod) { return mod->OnPreResurrect(player); });
     }
 
     void ModuleMgr::OnResurrect(Player* player)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnResurrect(player);
-        }
+        DispatchHook<ModuleHook::OnResurrect>([&](Module* mod) { mod->OnResurrect(player); });
     }
 
     void ModuleMgr::OnReleaseSpirit(Player* player, const WorldSafeLocsEntry* closestGrave)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnReleaseSpirit(player, closestGrave);
-        }
+        DispatchHook<ModuleHook::OnReleaseSpirit>([&](Module* mod) { mod->OnReleaseSpirit(player, closestGrave); });
     }
 
     void ModuleMgr::OnDeath(Player* player, Unit* killer)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnDeath(player, killer);
-        }
+        DispatchHook<ModuleHook::OnDeath>([&](Module* mod) { mod->OnDeath(player, killer); });
     }
 
     void ModuleMgr::OnDeath(Player* player, uint8 environmentalDamageType)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnDeath(player, environmentalDamageType);
-        }
+        DispatchHook<ModuleHook::OnEnvironmentalDeath>([&](Module* mod) { mod->OnDeath(player, environmentalDamageType); });
     }
 
     bool ModuleMgr::OnPreGiveXP(Player* player, uint32& xp, Creature* victim)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
-        {
-            if (mod->OnPreGiveXP(player, xp, victim))
-            {
-                overriden = true;
-            }
-        }
-
-        return overriden;
+        return DispatchOverrideHook<ModuleHook::OnPreGiveXP>([&](Module* mod) { return mod->OnPreGiveXP(player, xp, victim); });
     }
 
     void ModuleMgr::OnGiveXP(Player* player, uint32 xp, Creature* victim)
     {
-        for (Module* mod : modules)
+        DispatchHook<ModuleHook::OnGiveXP>([&](Module* mod) { mod->OnGiveXP(player, xp, victim); });
+
+        if (IsHookDeferred(ModuleHook::OnGiveXP))
         {
-            mod->OnGiveXP(player, xp, victim);
+            events.Push(CreateModuleEvent(ModuleHook::OnGiveXP, player, victim, xp));
         }
     }
 
     void ModuleMgr::OnGiveLevel(Player* player, uint32 level)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnGiveLevel(player, level);
-        }
+        chanceCache.Invalidate(player);
+
+        DispatchHook<ModuleHook::OnGiveLevel>([&](Module* mod) { mod->OnGiveLevel(player, level); });
     }
 
     void ModuleMgr::OnModifyMoney(Player* player, int32 diff)
     {
-        for (Module* mod : modules)
+        DispatchHook<ModuleHook::OnModifyMoney>([&](Module* mod) { mod->OnModifyMoney(player, diff); });
+
+        if (IsHookDeferred(ModuleHook::OnModifyMoney))
         {
-            mod->OnModifyMoney(player, diff);
+            events.Push(CreateModuleEvent(ModuleHook::OnModifyMoney, player, nullptr, diff));
         }
     }
 
     void ModuleMgr::OnSetReputation(Player* player, const FactionEntry* factionEntry, int32 standing, bool incremental)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnSetReputation(player, factionEntry, standing, incremental);
-        }
+        DispatchHook<ModuleHook::OnSetReputation>([&](Module* mod) { mod->OnSetReputation(player, factionEntry, standing, incremental); });
     }
 
     void ModuleMgr::OnRewardQuest(Player* player, const Quest* quest)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnRewardQuest(player, quest);
-        }
+        DispatchHook<ModuleHook::OnRewardQuest>([&](Module* mod) { mod->OnRewardQuest(player, quest); });
     }
 
     void ModuleMgr::OnGetPlayerClassLevelInfo(Player* player, PlayerClassLevelInfo& info)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnGetPlayerClassLevelInfo(player, info);
-        }
+        DispatchHook<ModuleHook::OnGetPlayerClassLevelInfo>([&](Module* mod) { mod->OnGetPlayerClassLevelInfo(player, info); });
     }
 
     void ModuleMgr::OnGetPlayerLevelInfo(Player* player, PlayerLevelInfo& info)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnGetPlayerLevelInfo(player, info);
-        }
+        DispatchHook<ModuleHook::OnGetPlayerLevelInfo>([&](Module* mod) { mod->OnGetPlayerLevelInfo(player, info); });
     }
 
     void ModuleMgr::OnSetVisibleItemSlot(Player* player, uint8 slot, Item* item)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnSetVisibleItemSlot(player, slot, item);
-        }
+        chanceCache.Invalidate(player);
+
+        DispatchHook<ModuleHook::OnSetVisibleItemSlot>([&](Module* mod) { mod->OnSetVisibleItemSlot(player, slot, item); });
     }
 
     void ModuleMgr::OnMoveItemFromInventory(Player* player, Item* item)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnMoveItemFromInventory(player, item);
-        }
+        inventoryIndex.OnRemoveItem(player, item);
+
+        DispatchHook<ModuleHook::OnMoveItemFromInventory>([&](Module* mod) { mod->OnMoveItemFromInventory(player, item); });
     }
 
     void ModuleMgr::OnMoveItemToInventory(Player* player, Item* item)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnMoveItemToInventory(player, item);
-        }
+        inventoryIndex.OnAddItem(player, item);
+
+        DispatchHook<ModuleHook::OnMoveItemToInventory>([&](Module* mod) { mod->OnMoveItemToInventory(player, item); });
     }
 
     void ModuleMgr::OnStoreItem(Player* player, Loot* loot, Item* item)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnStoreItem(player, loot, item);
-        }
+        inventoryIndex.OnAddItem(player, item);
+
+        DispatchHook<ModuleHook::OnStoreLootItem>([&](Module* mod) { mod->OnStoreItem(player, loot, item); });
     }
 
     void ModuleMgr::OnStoreItem(Player* player, Item* item)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnStoreItem(player, item);
-        }
+        inventoryIndex.OnAddItem(player, item);
+
+        DispatchHook<ModuleHook::OnStoreItem>([&](Module* mod) { mod->OnStoreItem(player, item); });
     }
 
     void ModuleMgr::OnAddSpell(Player* player, uint32 spellId)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnAddSpell(player, spellId);
-        }
+        DispatchHook<ModuleHook::OnAddSpell>([&](Module* mod) { mod->OnAddSpell(player, spellId); });
     }
 
     void ModuleMgr::OnDuelComplete(Player* player, Player* opponent, uint8 duelCompleteType)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnDuelComplete(player, opponent, duelCompleteType);
-        }
+        DispatchHook<ModuleHook::OnDuelComplete>([&](Module* mod) { mod->OnDuelComplete(player, opponent, duelCompleteType); });
     }
 
     void ModuleMgr::OnKilledMonsterCredit(Player* player, uint32 entry, ObjectGuid& guid)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnKilledMonsterCredit(player, entry, guid);
-        }
+        DispatchHook<ModuleHook::OnKilledMonsterCredit>([&](Module* mod) { mod->OnKilledMonsterCredit(player, entry, guid); });
     }
 
     bool ModuleMgr::OnPreRewardPlayerAtKill(Player* player, Unit* victim)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
-        {
-            if (mod->OnPreRewardPlayerAtKill(player, victim))
-            {
-                overriden = true;
-            }
-        }
-
-        return overriden;
+        return DispatchOverrideHook<ModuleHook::OnPreRewardPlayerAtKill>([&](Module* mod) { return mod->OnPreRewardPlayerAtKill(player, victim); });
     }
 
     void ModuleMgr::OnRewardPlayerAtKill(Player* player, Unit* victim)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnRewardPlayerAtKill(player, victim);
-        }
+        DispatchHook<ModuleHook::OnRewardPlayerAtKill>([&](Module* mod) { mod->OnRewardPlayerAtKill(player, victim); });
     }
 
     bool ModuleMgr::OnHandlePageTextQuery(Player* player, const WorldPacket& packet)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
-        {
-            if (mod->OnHandlePageTextQuery(player, packet))
-            {
-                overriden = true;
-            }
-        }
-
-        return overriden;
+        return DispatchOverrideHook<ModuleHook::OnHandlePageTextQuery>([&](Module* mod) { return mod->OnHandlePageTextQuery(player, packet); });
     }
 
     void ModuleMgr::OnUpdateSkill(Player* player, uint16 skillId)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnUpdateSkill(player, skillId);
-        }
+        DispatchHook<ModuleHook::OnUpdateSkill>([&](Module* mod) { mod->OnUpdateSkill(player, skillId); });
     }
 
     void ModuleMgr::OnRewardHonor(Player* player, Unit* victim)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnRewardHonor(player, victim);
-        }
+        DispatchHook<ModuleHook::OnRewardHonor>([&](Module* mod) { mod->OnRewardHonor(player, victim); });
     }
 
     void ModuleMgr::OnEquipItem(Player* player, Item* item)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnEquipItem(player, item);
-        }
+        inventoryIndex.OnAddItem(player, item);
+        chanceCache.Invalidate(player);
+
+        DispatchHook<ModuleHook::OnEquipItem>([&](Module* mod) { mod->OnEquipItem(player, item); });
     }
 
     void ModuleMgr::OnTaxiFlightRouteStart(Player* player, const Taxi::Tracker& taxiTracker, bool initial)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnTaxiFlightRouteStart(player, taxiTracker, initial);
-        }
+        DispatchHook<ModuleHook::OnTaxiFlightRouteStart>([&](Module* mod) { mod->OnTaxiFlightRouteStart(player, taxiTracker, initial); });
     }
 
     void ModuleMgr::OnTaxiFlightRouteEnd(Player* player, const Taxi::Tracker& taxiTracker, bool final)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnTaxiFlightRouteEnd(player, taxiTracker, final);
-        }
+        DispatchHook<ModuleHook::OnTaxiFlightRouteEnd>([&](Module* mod) { mod->OnTaxiFlightRouteEnd(player, taxiTracker, final); });
     }
 
     void ModuleMgr::OnEmote(Player* player, Unit* target, uint32 emote)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnEmote(player, target, emote);
-        }
+        DispatchHook<ModuleHook::OnEmote>([&](Module* mod) { mod->OnEmote(player, target, emote); });
     }
 
     void ModuleMgr::OnBuyBankSlot(Player* player, uint32 slot, uint32 price)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnBuyBankSlot(player, slot, price);
-        }
+        DispatchHook<ModuleHook::OnBuyBankSlot>([&](Module* mod) { mod->OnBuyBankSlot(player, slot, price); });
     }
 
-    void ModuleMgr::OnAddToWorld(Creature* creature)
+    template<typename Callback>
+    bool ModuleMgr::DispatchCreatureHook(ModuleHook hook, const Creature* creature, Callback callback)
     {
-        for (Module* mod : modules)
+        const CreatureHookModules& creatureSubscribers = creatureHookModules[GetCreatureHookIndex(hook)];
+        const uint32 entry = creature ? creature->GetEntry() : 0;
+        // The npc flags are only read when a module filters on them
+        const uint32 npcFlags = creature && creatureSubscribers.filter.UsesNpcFlags() ? creature->GetUInt32Value(UNIT_NPC_FLAGS) : 0;
+        if (!creature || !creatureSubscribers.filter.Matches(entry, npcFlags))
         {
-            mod->OnAddToWorld(creature);
+            // No module filters on this creature
+            for (Module* mod : creatureSubscribers.unfiltered)
+            {
+                MODULE_PROFILE_HOOK(mod, hook);
+                if (callback(mod))
+                {
+                    return true;
+                }
+            }
+
+            return false;
         }
-    }
 
-    bool ModuleMgr::OnRespawn(Creature* creature, time_t& respawnTime)
-    {
-        bool overriden = false;
-        for (Module* mod : modules)
+        for (const std::pair<Module*, const ModuleCreatureFilter*>& subscriber : creatureSubscribers.subscribers)
         {
-            if (mod->OnRespawn(creature, respawnTime))
+            if (!subscriber.second || subscriber.second->Matches(entry, npcFlags))
             {
-                overriden = true;
+                MODULE_PROFILE_HOOK(subscriber.first, hook);
+                if (callback(subscriber.first))
+                {
+                    return true;
+                }
             }
         }
 
-        return overriden;
+        return false;
     }
 
-    void ModuleMgr::OnRespawnRequest(Creature* creature)
+    void ModuleMgr::OnAddToWorld(Creature* creature)
     {
-        for (Module* mod : modules)
+        for (ModuleCreatureStateBase* state : creatureStates)
         {
-            mod->OnRespawnRequest(creature);
+            state->OnAddToWorld(creature);
         }
+
+        DispatchCreatureHook(ModuleHook::OnAddToWorld, creature, [&](Module* mod) { mod->OnAddToWorld(creature); return false; });
+    }
+
+    bool ModuleMgr::OnRespawn(Creature* creature, time_t& respawnTime)
+    {
+        return DispatchCreatureHook(ModuleHook::OnRespawn, creature, [&](Module* mod) { return mod->OnRespawn(creature, respawnTime); });
+    }
+
+    void ModuleMgr::OnRespawnRequest(Creature* creature)
+    {
+        DispatchCreatureHook(ModuleHook::OnRespawnRequest, creature, [&](Module* mod) { mod->OnRespawnRequest(creature); return false; });
     }
 
     bool ModuleMgr::OnUse(GameObject* gameObject, Unit* user)
     {
+        return DispatchOverrideHook<ModuleHook::OnUse>([&](Module* mod) { return mod->OnUse(gameObject, user); });
+    }
+
+    template<typename Callback>
+    bool ModuleMgr::CallChanceHook(Module* mod, ModuleHook hook, const Unit* unit, const Unit* target, uint32 variant, const SpellEntry* spellInfo, float& outChance, Callback callback)
+    {
+        if (!mod->IsChanceCached(hook))
+        {
+            return callback();
+        }
+
+        // The chance passed in is part of the key, the module may adjust it instead of replacing it
+        const uint32 spellId = spellInfo ? spellInfo->Id : 0;
+        const float inputChance = outChance;
         bool overriden = false;
-        for (Module* mod : modules)
+        float chance = 0.0f;
+        if (chanceCache.Get(hook, mod->GetId(), unit, target, variant, spellId, inputChance, overriden, chance))
         {
-            if (mod->OnUse(gameObject, user))
+            if (overriden)
             {
-                overriden = true;
+                outChance = chance;
             }
+
+            return overriden;
         }
 
+        overriden = callback();
+        chanceCache.Set(hook, mod->GetId(), unit, target, variant, spellId, inputChance, overriden, outChance);
         return overriden;
     }
 
     bool ModuleMgr::OnCalculateEffectiveDodgeChance(const Unit* unit, const Unit* attacker, uint8 attType, const SpellEntry* ability, float& outChance)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
+        bool overriden = DispatchOverrideHook<ModuleHook::OnCalculateEffectiveDodgeChance>([&](Module* mod) { return CallChanceHook(mod, ModuleHook::OnCalculateEffectiveDodgeChance, unit, attacker, attType, ability, outChance, [&]() { return mod->OnCalculateEffectiveDodgeChance(unit, attacker, attType, ability, outChance); }); });
+
+        if (!overriden && IsHookActive(ModuleHook::OnCalculateAttackTable))
         {
-            if (mod->OnCalculateEffectiveDodgeChance(unit, attacker, attType, ability, outChance))
-            {
-                overriden = true;
-            }
+            overriden = GetAttackTableChance(attacker, unit, attType, ability, ModuleAttackOutcome::Dodge, outChance);
         }
 
         return overriden;
@@ -708,13 +1091,11 @@ namespace cmangos_module
 
     bool ModuleMgr::OnCalculateEffectiveBlockChance(const Unit* unit, const Unit* attacker, uint8 attType, const SpellEntry* ability, float& outChance)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
+        bool overriden = DispatchOverrideHook<ModuleHook::OnCalculateEffectiveBlockChance>([&](Module* mod) { return CallChanceHook(mod, ModuleHook::OnCalculateEffectiveBlockChance, unit, attacker, attType, ability, outChance, [&]() { return mod->OnCalculateEffectiveBlockChance(unit, attacker, attType, ability, outChance); }); });
+
+        if (!overriden && IsHookActive(ModuleHook::OnCalculateAttackTable))
         {
-            if (mod->OnCalculateEffectiveBlockChance(unit, attacker, attType, ability, outChance))
-            {
-                overriden = true;
-            }
+            overriden = GetAttackTableChance(attacker, unit, attType, ability, ModuleAttackOutcome::Block, outChance);
         }
 
         return overriden;
@@ -722,13 +1103,11 @@ namespace cmangos_module
 
     bool ModuleMgr::OnCalculateEffectiveParryChance(const Unit* unit, const Unit* attacker, uint8 attType, const SpellEntry* ability, float& outChance)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
+        bool overriden = DispatchOverrideHook<ModuleHook::OnCalculateEffectiveParryChance>([&](Module* mod) { return CallChanceHook(mod, ModuleHook::OnCalculateEffectiveParryChance, unit, attacker, attType, ability, outChance, [&]() { return mod->OnCalculateEffectiveParryChance(unit, attacker, attType, ability, outChance); }); });
+
+        if (!overriden && IsHookActive(ModuleHook::OnCalculateAttackTable))
         {
-            if (mod->OnCalculateEffectiveParryChance(unit, attacker, attType, ability, outChance))
-            {
-                overriden = true;
-            }
+            overriden = GetAttackTableChance(attacker, unit, attType, ability, ModuleAttackOutcome::Parry, outChance);
         }
 
         return overriden;
@@ -736,13 +1115,11 @@ namespace cmangos_module
 
     bool ModuleMgr::OnCalculateEffectiveCritChance(const Unit* unit, const Unit* victim, uint8 attType, const SpellEntry* ability, float& outChance)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
+        bool overriden = DispatchOverrideHook<ModuleHook::OnCalculateEffectiveCritChance>([&](Module* mod) { return CallChanceHook(mod, ModuleHook::OnCalculateEffectiveCritChance, unit, victim, attType, ability, outChance, [&]() { return mod->OnCalculateEffectiveCritChance(unit, victim, attType, ability, outChance); }); });
+
+        if (!overriden && IsHookActive(ModuleHook::OnCalculateAttackTable))
         {
-            if (mod->OnCalculateEffectiveCritChance(unit, victim, attType, ability, outChance))
-            {
-                overriden = true;
-            }
+            overriden = GetAttackTableChance(unit, victim, attType, ability, ModuleAttackOutcome::Crit, outChance);
         }
 
         return overriden;
@@ -750,512 +1127,644 @@ namespace cmangos_module
 
     bool ModuleMgr::OnCalculateEffectiveMissChance(const Unit* unit, const Unit* victim, uint8 attType, const SpellEntry* ability, const Spell* const* currentSpells, const SpellPartialResistDistribution& spellPartialResistDistribution, float& outChance)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
+        bool overriden = DispatchOverrideHook<ModuleHook::OnCalculateEffectiveMissChance>([&](Module* mod) { return mod->OnCalculateEffectiveMissChance(unit, victim, attType, ability, currentSpells, spellPartialResistDistribution, outChance); });
+
+        if (!overriden && IsHookActive(ModuleHook::OnCalculateAttackTable))
         {
-            if (mod->OnCalculateEffectiveMissChance(unit, victim, attType, ability, currentSpells, spellPartialResistDistribution, outChance))
-            {
-                overriden = true;
-            }
+            overriden = GetAttackTableChance(unit, victim, attType, ability, ModuleAttackOutcome::Miss, outChance);
         }
 
         return overriden;
     }
 
-    bool ModuleMgr::OnCalculateSpellMissChance(const Unit* unit, const Unit* victim, uint32 schoolMask, const SpellEntry* spell, float& outChance)
+    bool ModuleMgr::GetAttackTableChance(const Unit* attacker, const Unit* victim, uint8 attType, const SpellEntry* ability, ModuleAttackOutcome outcome, float& outChance)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
+        const ModuleAttackRoll* roll = ModuleAttackRoll::GetCurrent();
+        if (roll && roll->IsFor(attacker, victim, attType, ability))
         {
-            if (mod->OnCalculateSpellMissChance(unit, victim, schoolMask, spell, outChance))
+            if (roll->GetTable().Has(outcome))
             {
-                overriden = true;
+                outChance = roll->GetTable().Get(outcome);
+                return true;
             }
+
+            return false;
         }
 
-        return overriden;
+        // A chance asked outside of a roll gets a table of its own
+        ModuleAttackTable table;
+        OnCalculateAttackTable(attacker, victim, attType, ability, table);
+        if (table.Has(outcome))
+        {
+            outChance = table.Get(outcome);
+            return true;
+        }
+
+        return false;
+    }
+
+    void ModuleMgr::OnCalculateAttackTable(const Unit* attacker, const Unit* victim, uint8 attType, const SpellEntry* ability, ModuleAttackTable& table)
+    {
+        table.Reset();
+        DispatchHook<ModuleHook::OnCalculateAttackTable>([&](Module* mod) { mod->OnCalculateAttackTable(attacker, victim, attType, ability, table); });
+    }
+
+    thread_local const ModuleAttackRoll* ModuleAttackRoll::current = nullptr;
+
+    ModuleAttackRoll::ModuleAttackRoll(const Unit* attacker, const Unit* victim, uint8 attType, const SpellEntry* ability)
+    : attacker(attacker)
+    , victim(victim)
+    , ability(ability)
+    , attType(attType)
+    , previous(current)
+    {
+        if (ModuleMgr::IsHookActive(ModuleHook::OnCalculateAttackTable))
+        {
+            sModuleMgr.OnCalculateAttackTable(attacker, victim, attType, ability, table);
+        }
+
+        current = this;
+    }
+
+    ModuleAttackRoll::~ModuleAttackRoll()
+    {
+        current = previous;
+    }
+
+    bool ModuleMgr::OnCalculateSpellMissChance(const Unit* unit, const Unit* victim, uint32 schoolMask, const SpellEntry* spell, float& outChance)
+    {
+        return DispatchOverrideHook<ModuleHook::OnCalculateSpellMissChance>([&](Module* mod) { return CallChanceHook(mod, ModuleHook::OnCalculateSpellMissChance, unit, victim, schoolMask, spell, outChance, [&]() { return mod->OnCalculateSpellMissChance(unit, victim, schoolMask, spell, outChance); }); });
     }
 
     bool ModuleMgr::OnGetAttackDistance(const Unit* unit, const Unit* target, float& outDistance)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
+        if (IsStaticHook(ModuleHook::OnGetAttackDistance))
         {
-            if (mod->OnGetAttackDistance(unit, target, outDistance))
-            {
-                overriden = true;
-            }
+            return staticHooks->OnGetAttackDistance(unit, target, outDistance);
         }
 
-        return overriden;
+        return DispatchOverrideHook<ModuleHook::OnGetAttackDistance>([&](Module* mod) { return mod->OnGetAttackDistance(unit, target, outDistance); });
     }
 
     void ModuleMgr::OnDealDamage(Unit* unit, Unit* victim, uint32 health, uint32 damage)
     {
-        for (Module* mod : modules)
+        if (IsStaticHook(ModuleHook::OnDealDamage))
+        {
+            staticHooks->OnDealDamage(unit, victim, health, damage);
+        }
+        else
+        {
+            DispatchHook<ModuleHook::OnDealDamage>([&](Module* mod) { mod->OnDealDamage(unit, victim, health, damage); });
+        }
+
+        if (IsHookDeferred(ModuleHook::OnDealDamage))
         {
-            mod->OnDealDamage(unit, victim, health, damage);
+            events.Push(CreateModuleEvent(ModuleHook::OnDealDamage, unit, victim, damage, health));
         }
     }
 
     void ModuleMgr::OnKill(Unit* unit, Unit* victim)
     {
-        for (Module* mod : modules)
+        if (IsStaticHook(ModuleHook::OnKill))
+        {
+            staticHooks->OnKill(unit, victim);
+        }
+        else
+        {
+            DispatchHook<ModuleHook::OnKill>([&](Module* mod) { mod->OnKill(unit, victim); });
+        }
+
+        if (IsHookDeferred(ModuleHook::OnKill))
+        {
+            events.Push(CreateModuleEvent(ModuleHook::OnKill, unit, victim, 0));
+        }
+    }
+
+    void ModuleMgr::OnDealHeal(Unit* unit, Unit* victim, int32 gain, uint32 addHealth)
+    {
+        if (IsStaticHook(ModuleHook::OnDealHeal))
+        {
+            staticHooks->OnDealHeal(unit, victim, gain, addHealth);
+        }
+        else
+        {
+            DispatchHook<ModuleHook::OnDealHeal>([&](Module* mod) { mod->OnDealHeal(unit, victim, gain, addHealth); });
+        }
+
+        if (IsHookDeferred(ModuleHook::OnDealHeal))
+        {
+            events.Push(CreateModuleEvent(ModuleHook::OnDealHeal, unit, victim, gain, addHealth));
+        }
+    }
+
+    void ModuleMgr::OnSetPower(Unit* unit, uint8 power, uint32& value)
+    {
+        if (IsStaticHook(ModuleHook::OnSetPower))
         {
-            mod->OnKill(unit, victim);
+            staticHooks->OnSetPower(unit, power, value);
+            return;
         }
+
+        DispatchHook<ModuleHook::OnSetPower>([&](Module* mod) { mod->OnSetPower(unit, power, value); });
     }
 
-    void ModuleMgr::OnDealHeal(Unit* unit, Unit* victim, int32 gain, uint32 addHealth)
+    bool ModuleMgr::OnGetReactionTo(const Unit* unit, const Unit* target, ReputationRank& outReaction)
     {
-        for (Module* mod : modules)
+        if (IsStaticHook(ModuleHook::OnGetReactionTo))
         {
-            mod->OnDealHeal(unit, victim, gain, addHealth);
+            return staticHooks->OnGetReactionTo(unit, target, outReaction);
         }
+
+        return DispatchOverrideHook<ModuleHook::OnGetReactionTo>([&](Module* mod) { return mod->OnGetReactionTo(unit, target, outReaction); });
     }
 
-    void ModuleMgr::OnSetPower(Unit* unit, uint8 power, uint32& value)
+    bool ModuleMgr::OnGetSpellRank(const Unit* unit, const SpellEntry* spellInfo, uint32& outSpellRank)
     {
-        for (Module* mod : modules)
+        if (IsStaticHook(ModuleHook::OnGetSpellRank))
         {
-            mod->OnSetPower(unit, power, value);
+            return staticHooks->OnGetSpellRank(unit, spellInfo, outSpellRank);
         }
+
+        return DispatchOverrideHook<ModuleHook::OnGetSpellRank>([&](Module* mod) { return mod->OnGetSpellRank(unit, spellInfo, outSpellRank); });
     }
 
-    bool ModuleMgr::OnGetReactionTo(const Unit* unit, const Unit* target, ReputationRank& outReaction)
+    template<typename Callback>
+    bool ModuleMgr::DispatchSpellHook(ModuleHook hook, const SpellEntry* spellInfo, Callback callback)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
+        const SpellHookModules& spellSubscribers = spellHookModules[GetSpellHookIndex(hook)];
+        if (!spellInfo || !spellSubscribers.filter.Matches(spellInfo->Id, spellInfo->SpellFamilyName))
         {
-            if (mod->OnGetReactionTo(unit, target, outReaction))
+            // No module filters on this spell
+            for (Module* mod : spellSubscribers.unfiltered)
             {
-                overriden = true;
+                MODULE_PROFILE_HOOK(mod, hook);
+                if (callback(mod))
+                {
+                    return true;
+                }
             }
-        }
 
-        return overriden;
-    }
+            return false;
+        }
 
-    bool ModuleMgr::OnGetSpellRank(const Unit* unit, const SpellEntry* spellInfo, uint32& outSpellRank)
-    {
-        bool overriden = false;
-        for (Module* mod : modules)
+        for (const std::pair<Module*, const ModuleSpellFilter*>& subscriber : spellSubscribers.subscribers)
         {
-            if (mod->OnGetSpellRank(unit, spellInfo, outSpellRank))
+            if (!subscriber.second || subscriber.second->Matches(spellInfo->Id, spellInfo->SpellFamilyName))
             {
-                overriden = true;
+                MODULE_PROFILE_HOOK(subscriber.first, hook);
+                if (callback(subscriber.first))
+                {
+                    return true;
+                }
             }
         }
 
-        return overriden;
+        return false;
     }
 
     void ModuleMgr::OnHit(Spell* spell, Unit* caster, Unit* victim)
     {
-        for (Module* mod : modules)
+        DispatchSpellHook(ModuleHook::OnHit, spell ? spell->m_spellInfo : nullptr, [&](Module* mod)
         {
             mod->OnHit(spell, caster, victim);
-        }
+            return false;
+        });
     }
 
     void ModuleMgr::OnCast(Spell* spell, Unit* caster, Unit* victim)
     {
-        for (Module* mod : modules)
+        DispatchSpellHook(ModuleHook::OnCast, spell ? spell->m_spellInfo : nullptr, [&](Module* mod)
         {
             mod->OnCast(spell, caster, victim);
-        }
+            return false;
+        });
     }
 
     void ModuleMgr::OnProc(const ProcExecutionData& data, SpellAuraProcResult& procResult)
     {
-        for (Module* mod : modules)
+        DispatchSpellHook(ModuleHook::OnProc, data.triggeredByAura ? data.triggeredByAura->GetSpellProto() : nullptr, [&](Module* mod)
         {
             mod->OnProc(data, procResult);
-        }
+            return false;
+        });
     }
 
     bool ModuleMgr::OnPeriodicTick(Aura* aura)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
+        return DispatchSpellHook(ModuleHook::OnPeriodicTick, aura ? aura->GetSpellProto() : nullptr, [&](Module* mod)
         {
-            if (mod->OnPeriodicTick(aura))
-            {
-                overriden = true;
-            }
-        }
-
-        return overriden;
+            return mod->OnPeriodicTick(aura);
+        });
     }
 
     bool ModuleMgr::OnFillLoot(Loot* loot, Player* owner)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
-        {
-            if (mod->OnFillLoot(loot, owner))
-            {
-                overriden = true;
-            }
-        }
-
-        return overriden;
+        return DispatchOverrideHook<ModuleHook::OnFillLoot>([&](Module* mod) { return mod->OnFillLoot(loot, owner); });
     }
 
     bool ModuleMgr::OnGenerateMoneyLoot(Loot* loot, uint32& outMoney)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
-        {
-            if (mod->OnGenerateMoneyLoot(loot, outMoney))
-            {
-                overriden = true;
-            }
-        }
-
-        return overriden;
+        return DispatchOverrideHook<ModuleHook::OnGenerateMoneyLoot>([&](Module* mod) { return mod->OnGenerateMoneyLoot(loot, outMoney); });
     }
 
     void ModuleMgr::OnAddItem(Loot* loot, LootItem* lootItem)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnAddItem(loot, lootItem);
-        }
+        DispatchHook<ModuleHook::OnAddItem>([&](Module* mod) { mod->OnAddItem(loot, lootItem); });
     }
 
     void ModuleMgr::OnSendGold(Loot* loot, Player* player, uint32 gold, uint8 lootMethod)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnSendGold(loot, player, gold, lootMethod);
-        }
+        DispatchHook<ModuleHook::OnSendGold>([&](Module* mod) { mod->OnSendGold(loot, player, gold, lootMethod); });
     }
 
     void ModuleMgr::OnHandleLootMasterGive(Loot* loot, Player* target, LootItem* lootItem)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnHandleLootMasterGive(loot, target, lootItem);
-        }
+        DispatchHook<ModuleHook::OnHandleLootMasterGive>([&](Module* mod) { mod->OnHandleLootMasterGive(loot, target, lootItem); });
     }
 
     void ModuleMgr::OnPlayerRoll(Loot* loot, Player* player, uint32 itemSlot, uint8 rollType)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnPlayerRoll(loot, player, itemSlot, rollType);
-        }
+        DispatchHook<ModuleHook::OnPlayerRoll>([&](Module* mod) { mod->OnPlayerRoll(loot, player, itemSlot, rollType); });
     }
 
     void ModuleMgr::OnPlayerWinRoll(Loot* loot, Player* player, uint8 rollType, uint8 rollAmount, uint32 itemSlot, uint8 inventoryResult)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnPlayerWinRoll(loot, player, rollType, rollAmount, itemSlot, inventoryResult);
-        }
+        DispatchHook<ModuleHook::OnPlayerWinRoll>([&](Module* mod) { mod->OnPlayerWinRoll(loot, player, rollType, rollAmount, itemSlot, inventoryResult); });
     }
 
     void ModuleMgr::OnStartBattleGround(BattleGround* battleground)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnStartBattleGround(battleground);
-        }
+        DispatchHook<ModuleHook::OnStartBattleGround>([&](Module* mod) { mod->OnStartBattleGround(battleground); });
     }
 
     void ModuleMgr::OnEndBattleGround(BattleGround* battleground, uint32 winnerTeam)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnEndBattleGround(battleground, winnerTeam);
-        }
+        DispatchHook<ModuleHook::OnEndBattleGround>([&](Module* mod) { mod->OnEndBattleGround(battleground, winnerTeam); });
     }
 
     void ModuleMgr::OnUpdatePlayerScore(BattleGround* battleground, Player* player, uint8 scoreType, uint32 value)
     {
-        for (Module* mod : modules)
+        DispatchHook<ModuleHook::OnUpdatePlayerScore>([&](Module* mod) { mod->OnUpdatePlayerScore(battleground, player, scoreType, value); });
+
+        if (IsHookDeferred(ModuleHook::OnUpdatePlayerScore))
         {
-            mod->OnUpdatePlayerScore(battleground, player, scoreType, value);
+            events.Push(CreateModuleEvent(ModuleHook::OnUpdatePlayerScore, player, nullptr, value, scoreType));
         }
     }
 
     void ModuleMgr::OnLeaveBattleGround(BattleGround* battleground, Player* player)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnLeaveBattleGround(battleground, player);
-        }
+        DispatchHook<ModuleHook::OnLeaveBattleGround>([&](Module* mod) { mod->OnLeaveBattleGround(battleground, player); });
     }
 
     void ModuleMgr::OnJoinBattleGround(BattleGround* battleground, Player* player)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnJoinBattleGround(battleground, player);
-        }
+        DispatchHook<ModuleHook::OnJoinBattleGround>([&](Module* mod) { mod->OnJoinBattleGround(battleground, player); });
     }
 
     void ModuleMgr::OnPickUpFlag(BattleGroundWS* battleground, Player* player, uint32 team)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnPickUpFlag(battleground, player, team);
-        }
+        DispatchHook<ModuleHook::OnPickUpFlag>([&](Module* mod) { mod->OnPickUpFlag(battleground, player, team); });
     }
 
     void ModuleMgr::OnAddMember(Group* group, Player* player, uint8 method)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnAddMember(group, player, method);
-        }
+        DispatchHook<ModuleHook::OnAddMember>([&](Module* mod) { mod->OnAddMember(group, player, method); });
     }
 
     void ModuleMgr::OnRemoveMember(Group* group, Player* player, uint8 method)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnRemoveMember(group, player, method);
-        }
+        DispatchHook<ModuleHook::OnRemoveMember>([&](Module* mod) { mod->OnRemoveMember(group, player, method); });
     }
 
     bool ModuleMgr::OnPreInviteMember(Group* group, Player* player, Player* recipient)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
-        {
-            if (mod->OnPreInviteMember(group, player, recipient))
-            {
-                overriden = true;
-            }
-        }
-
-        return overriden;
+        return DispatchOverrideHook<ModuleHook::OnPreInviteMember>([&](Module* mod) { return mod->OnPreInviteMember(group, player, recipient); });
     }
 
     void ModuleMgr::OnSellItem(AuctionEntry* auctionEntry, Player* player)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnSellItem(auctionEntry, player);
-        }
+        DispatchHook<ModuleHook::OnSellAuctionItem>([&](Module* mod) { mod->OnSellItem(auctionEntry, player); });
     }
 
     void ModuleMgr::OnSellItem(Player* player, Item* item, uint32 money)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnSellItem(player, item, money);
-        }
+        inventoryIndex.OnRemoveItem(player, item);
+
+        DispatchHook<ModuleHook::OnSellItem>([&](Module* mod) { mod->OnSellItem(player, item, money); });
     }
 
     void ModuleMgr::OnBuyBackItem(Player* player, Item* item, uint32 money)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnBuyBackItem(player, item, money);
-        }
+        inventoryIndex.OnAddItem(player, item);
+
+        DispatchHook<ModuleHook::OnBuyBackItem>([&](Module* mod) { mod->OnBuyBackItem(player, item, money); });
     }
 
     void ModuleMgr::OnCreateItem(Player* player, Item* item, uint32 amount)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnCreateItem(player, item, amount);
-        }
+        inventoryIndex.OnAddItem(player, item);
+
+        DispatchHook<ModuleHook::OnCreateItem>([&](Module* mod) { mod->OnCreateItem(player, item, amount); });
+    }
+
+    void ModuleMgr::OnDestroyItem(Player* player, Item* item)
+    {
+        inventoryIndex.OnRemoveItem(player, item);
+
+        DispatchHook<ModuleHook::OnDestroyItem>([&](Module* mod) { mod->OnDestroyItem(player, item); });
     }
 
     void ModuleMgr::OnSummoned(Player* player, const ObjectGuid& summoner)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnSummoned(player, summoner);
-        }
+        DispatchHook<ModuleHook::OnSummoned>([&](Module* mod) { mod->OnSummoned(player, summoner); });
     }
 
     void ModuleMgr::OnAreaExplored(Player* player, uint32 areaId)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnAreaExplored(player, areaId);
-        }
+        DispatchHook<ModuleHook::OnAreaExplored>([&](Module* mod) { mod->OnAreaExplored(player, areaId); });
     }
 
     void ModuleMgr::OnUpdateHonor(Player* player)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnUpdateHonor(player);
-        }
+        DispatchHook<ModuleHook::OnUpdateHonor>([&](Module* mod) { mod->OnUpdateHonor(player); });
     }
 
     void ModuleMgr::OnAcceptQuest(Player* player, uint32 questId, const ObjectGuid* questGiver)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnAcceptQuest(player, questId, questGiver);
-        }
+        DispatchHook<ModuleHook::OnAcceptQuest>([&](Module* mod) { mod->OnAcceptQuest(player, questId, questGiver); });
     }
 
     void ModuleMgr::OnAbandonQuest(Player* player, uint32 questId)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnAbandonQuest(player, questId);
-        }
+        DispatchHook<ModuleHook::OnAbandonQuest>([&](Module* mod) { mod->OnAbandonQuest(player, questId); });
     }
 
     bool ModuleMgr::OnPreHandleInitializeTrade(Player* player, Player* trader)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
-        {
-            if (mod->OnPreHandleInitializeTrade(player, trader))
-            {
-                overriden = true;
-            }
-        }
-
-        return overriden;
+        return DispatchOverrideHook<ModuleHook::OnPreHandleInitializeTrade>([&](Module* mod) { return mod->OnPreHandleInitializeTrade(player, trader); });
     }
 
     void ModuleMgr::OnTradeAccepted(Player* player, Player* trader, TradeData* playerTrade, TradeData* traderTrade)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnTradeAccepted(player, trader, playerTrade, traderTrade);
-        }
+        DispatchHook<ModuleHook::OnTradeAccepted>([&](Module* mod) { mod->OnTradeAccepted(player, trader, playerTrade, traderTrade); });
     }
 
     void ModuleMgr::OnRegenerate(Player* player, uint8 power, uint32 diff, float& addedValue)
     {
-        for (Module* mod : modules)
+        if (IsStaticHook(ModuleHook::OnRegenerate))
         {
-            mod->OnRegenerate(player, power, diff, addedValue);
+            staticHooks->OnRegenerate(player, power, diff, addedValue);
+            return;
         }
+
+        DispatchHook<ModuleHook::OnRegenerate>([&](Module* mod) { mod->OnRegenerate(player, power, diff, addedValue); });
     }
 
     bool ModuleMgr::OnCanCheckMailBox(Player* player, const ObjectGuid& mailboxGuid, bool& outResult)
     {
-        bool overriden = false;
-        for (Module* mod : modules)
-        {
-            if (mod->OnCanCheckMailBox(player, mailboxGuid, outResult))
-            {
-                overriden = true;
-            }
-        }
-
-        return overriden;
+        return DispatchOverrideHook<ModuleHook::OnCanCheckMailBox>([&](Module* mod) { return mod->OnCanCheckMailBox(player, mailboxGuid, outResult); });
     }
 
     void ModuleMgr::OnUpdateBid(AuctionEntry* auctionEntry, Player* player, uint32 newBid)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnUpdateBid(auctionEntry, player, newBid);
-        }
+        DispatchHook<ModuleHook::OnUpdateBid>([&](Module* mod) { mod->OnUpdateBid(auctionEntry, player, newBid); });
     }
 
     void ModuleMgr::OnActionBidWinning(AuctionEntry* auctionEntry, const ObjectGuid& owner, const ObjectGuid& bidder)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnActionBidWinning(auctionEntry, owner, bidder);
-        }
+        DispatchHook<ModuleHook::OnActionBidWinning>([&](Module* mod) { mod->OnActionBidWinning(auctionEntry, owner, bidder); });
     }
 
     void ModuleMgr::OnSendMail(const MailDraft& mail, Player* player, const ObjectGuid& receiver, uint32 cost)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnSendMail(mail, player, receiver, cost);
-        }
+        DispatchHook<ModuleHook::OnSendMail>([&](Module* mod) { mod->OnSendMail(mail, player, receiver, cost); });
     }
 
     void ModuleMgr::OnMailTakeItem(Mail* mail, Player* player, Item* item, const ObjectGuid& sender)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnMailTakeItem(mail, player, item, sender);
-        }
+        DispatchHook<ModuleHook::OnMailTakeItem>([&](Module* mod) { mod->OnMailTakeItem(mail, player, item, sender); });
     }
 
     void ModuleMgr::OnMailTakeMoney(Mail* mail, Player* player, uint32 amount, const ObjectGuid& sender)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnMailTakeMoney(mail, player, amount, sender);
-        }
+        DispatchHook<ModuleHook::OnMailTakeMoney>([&](Module* mod) { mod->OnMailTakeMoney(mail, player, amount, sender); });
     }
 
     void ModuleMgr::OnWriteDump(uint32 playerId, std::string& dump)
     {
-        for (Module* mod : modules)
-        {
-            mod->OnWriteDump(playerId, dump);
-        }
+        DispatchHook<ModuleHook::OnWriteDump>([&](Module* mod) { mod->OnWriteDump(playerId, dump); });
     }
 
     bool ModuleMgr::IsModuleDumpTable(const std::string& dbTableName)
     {
-        for (Module* mod : modules)
+        return DispatchOverrideHook<ModuleHook::IsModuleDumpTable>([&](Module* mod) { return mod->IsModuleDumpTable(dbTableName); });
+    }
+
+    bool ModuleMgr::OnExecuteCommand(ChatHandler* chatHandler, const std::string& cmd)
+    {
+        // Commands are formed by "prefix subcommand [args]"
+        const std::string_view command(cmd);
+        const size_t prefixEnd = command.find(' ');
+        if (prefixEnd == std::string_view::npos || prefixEnd == 0)
+        {
+            return false;
+        }
+
+        const size_t subcommandEnd = command.find(' ', prefixEnd + 1);
+        if (command.substr(0, prefixEnd) == "modules")
+        {
+            const std::string_view args = subcommandEnd != std::string_view::npos ? command.substr(subcommandEnd + 1) : std::string_view();
+            return HandleModulesCommand(chatHandler, command.substr(prefixEnd + 1, subcommandEnd - prefixEnd - 1), args);
+        }
+
+        auto commandIt = commands.find(command.substr(0, subcommandEnd));
+        if (commandIt == commands.end())
+        {
+            return false;
+        }
+
+        // Walk down the subcommand tree for as long as the next word matches
+        size_t commandEnd = subcommandEnd;
+        while (commandEnd != std::string_view::npos && !commandIt->second.command->subcommands.empty())
+        {
+            // Keys use a single space between words
+            const size_t nextStart = commandEnd + 1;
+            if (nextStart >= command.size() || command[nextStart] == ' ')
+            {
+                break;
+            }
+
+            const size_t nextEnd = command.find(' ', nextStart);
+            const auto subcommandIt = commands.find(command.substr(0, nextEnd));
+            if (subcommandIt == commands.end())
+            {
+                break;
+            }
+
+            commandIt = subcommandIt;
+            commandEnd = nextEnd;
+        }
+
+        // Module commands are only available from within the game
+        WorldSession* session = chatHandler->GetSession();
+        const CommandEntry& entry = commandIt->second;
+        const ModuleChatCommand& chatCommand = *entry.command;
+        if (!session || session->GetSecurity() < chatCommand.securityLevel)
+        {
+            return false;
+        }
+
+        const std::string_view args = commandEnd != std::string_view::npos ? command.substr(commandEnd + 1) : std::string_view();
+        if (chatCommand.handler)
         {
-            if (mod->IsModuleDumpTable(dbTableName))
+            ModuleCommandArgs parsedArgs;
+            if (!parsedArgs.Parse(chatCommand.arguments, args))
             {
+                chatHandler->PSendSysMessage("Usage: .%s", entry.usage.c_str());
                 return true;
             }
+
+            return chatCommand.handler(session, parsedArgs);
+        }
+        else if (chatCommand.callback)
+        {
+            return chatCommand.callback(session, std::string(args));
         }
 
         return false;
     }
 
-    bool ModuleMgr::OnExecuteCommand(ChatHandler* chatHandler, const std::string& cmd)
+    void ModuleMgr::BuildCommandTable()
     {
-        if (!cmd.empty())
+        commands.clear();
+        commandKeys.clear();
+
+        // The keys must be stored first as the table only holds views into them
+        std::vector<const ModuleChatCommand*> chatCommands;
+        for (Module* mod : modules)
         {
-            // Extract the prefix and suffix of the cmd
-            std::string cmdSuffix, cmdArgs;
-            std::string cmdPrefix = cmd;
-            size_t spacePos = cmd.find(' ');
-            if (spacePos != std::string::npos)
+            const char* moduleCommandPrefix = mod->GetChatCommandPrefix();
+            std::vector<ModuleChatCommand>* commandTable = mod->GetCommandTable();
+            if (moduleCommandPrefix && *moduleCommandPrefix && commandTable)
             {
-                cmdPrefix = cmd.substr(0, spacePos);
-                cmdSuffix = cmd.substr(spacePos + 1);
+                AddCommands(moduleCommandPrefix, *commandTable, chatCommands);
+            }
+        }
 
-                // Extract possible extra args from suffix
-                spacePos = cmdSuffix.find(' ');
-                if (spacePos != std::string::npos)
-                {
-                    cmdArgs = cmdSuffix.substr(spacePos + 1);
-                    cmdSuffix = cmdSuffix.substr(0, spacePos);
-                }
+        commands.reserve(commandKeys.size());
+        for (size_t i = 0; i < commandKeys.size(); ++i)
+        {
+            const ModuleChatCommand* chatCommand = chatCommands[i];
+            std::string usage = commandKeys[i];
+            if (!chatCommand->arguments.empty())
+            {
+                usage += ' ';
+                usage += ModuleCommandArgs::GetUsage(chatCommand->arguments);
+            }
+
+            if (!commands.emplace(commandKeys[i], CommandEntry{ chatCommand, std::move(usage) }).second)
+            {
+                sLog.outError("Module command '%s' is registered more than once, only the first one will be used", commandKeys[i].c_str());
+            }
+        }
+    }
+
+    void ModuleMgr::AddCommands(const std::string& path, const std::vector<ModuleChatCommand>& commandTable, std::vector<const ModuleChatCommand*>& chatCommands)
+    {
+        for (const ModuleChatCommand& chatCommand : commandTable)
+        {
+            if (chatCommand.arguments.size() > MODULE_COMMAND_MAX_ARGS)
+            {
+                sLog.outError("Module command '%s %s' has more than %u arguments, it will be ignored", path.c_str(), chatCommand.name.c_str(), MODULE_COMMAND_MAX_ARGS);
+                continue;
             }
 
-            if (!cmdPrefix.empty() && !cmdSuffix.empty())
+            // Copied, adding the keys of the subcommands can reallocate commandKeys
+            const std::string key = path + " " + chatCommand.name;
+            commandKeys.push_back(key);
+            chatCommands.push_back(&chatCommand);
+            if (!chatCommand.subcommands.empty())
             {
-                WorldSession* session = chatHandler->GetSession();
-                for (Module* mod : modules)
+                AddCommands(key, chatCommand.subcommands, chatCommands);
+            }
+        }
+    }
+
+    bool ModuleMgr::HandleModulesCommand(ChatHandler* chatHandler, std::string_view subcommand, std::string_view args)
+    {
+        // Console sessions don't have a world session
+        const WorldSession* session = chatHandler->GetSession();
+        if (session && session->GetSecurity() < SEC_ADMINISTRATOR)
+        {
+            return false;
+        }
+
+        if (subcommand == "tasks")
+        {
+            scheduler.Print(chatHandler);
+            return true;
+        }
+        else if (subcommand == "reload")
+        {
+            if (args == "watch on" || args == "watch off")
+            {
+                SetConfigWatch(args == "watch on");
+                chatHandler->PSendSysMessage("Module configuration file watch %s", configWatchTask ? "enabled" : "disabled");
+            }
+            else
+            {
+                const uint32 reloaded = ReloadConfigs(args);
+                chatHandler->PSendSysMessage("Reloaded the configuration of %u modules", reloaded);
+            }
+
+            return true;
+        }
+        else if (subcommand == "inventory")
+        {
+            if (args == "debug on" || args == "debug off")
+            {
+                inventoryIndex.SetVerify(args == "debug on");
+                chatHandler->PSendSysMessage("Module inventory index verification after every change %s", inventoryIndex.IsVerifying() ? "enabled" : "disabled");
+            }
+            else
+            {
+                inventoryIndex.VerifyAll(chatHandler);
+            }
+
+            return true;
+        }
+#ifdef MODULES_PROFILING
+        else if (subcommand == "profile")
+        {
+            if (args == "reset")
+            {
+                profiler.Reset();
+                chatHandler->SendSysMessage("Module profiler data reset");
+            }
+            else
+            {
+                // Counts too large for a uint32 get clamped like the others
+                uint32 count = 10;
+                if (!args.empty())
                 {
-                    const char* moduleCommandPrefix = mod->GetChatCommandPrefix();
-                    if (moduleCommandPrefix && moduleCommandPrefix == cmdPrefix)
+                    const std::from_chars_result result = std::from_chars(args.data(), args.data() + args.size(), count);
+                    if (result.ec == std::errc::result_out_of_range)
                     {
-                        std::vector<ModuleChatCommand>* commandTable = mod->GetCommandTable();
-                        if (commandTable)
-                        {
-                            for (auto chatCommand : *commandTable)
-                            {
-                                if (chatCommand.name == cmdSuffix && session->GetSecurity() >= chatCommand.securityLevel)
-                                {
-                                    return chatCommand.callback(session, cmdArgs);
-                                }
-                            }
-                        }
+                        count = MODULE_PROFILER_MAX_PRINT_COUNT;
+                    }
+                    else if (result.ec != std::errc() || result.ptr != args.data() + args.size())
+                    {
+                        count = 10;
                     }
                 }
+
+                profiler.Print(chatHandler, std::min(count, MODULE_PROFILER_MAX_PRINT_COUNT));
             }
+
+            return true;
         }
+#endif
 
         return false;
     }
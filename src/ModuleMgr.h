@@ -3,9 +3,27 @@
 
 #include "Platform/Define.h"
 #include "Entities/Unit.h"
+#include "ModuleAttackTable.h"
+#include "ModuleChanceCache.h"
+#include "ModuleCreatureFilter.h"
+#include "ModuleCreatureState.h"
+#include "ModuleEvent.h"
+#include "ModuleHook.h"
+#include "ModuleInventoryIndex.h"
+#include "ModulePlayerState.h"
+#include "ModuleProfiler.h"
+#include "ModuleQuery.h"
+#include "ModuleScheduler.h"
+#include "ModuleSpellFilter.h"
 
+#include <array>
+#include <bitset>
+#include <filesystem>
 #include <map>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 class BattleGround;
@@ -21,6 +39,7 @@ class ObjectGuid;
 class Player;
 class Quest;
 class Spell;
+class SqlQueryHolder;
 namespace Taxi { class Tracker; }
 class TradeData;
 class Unit;
@@ -46,15 +65,59 @@ typedef std::vector<SpellPartialResistChanceEntry> SpellPartialResistDistributio
 namespace cmangos_module
 {
     class Module;
+    class ModuleConfig;
+    struct ModuleChatCommand;
+    enum class ModuleAttackOutcome : uint8;
+    struct ModuleStaticHooks;
 
     class ModuleMgr
     {
     public:
-        ModuleMgr() {}
+        ModuleMgr() : staticHooks(nullptr), creatureStateSweepTimer(0), configWatchTask(0) {}
         ~ModuleMgr();
 
         void RegisterModule(Module* module);
 
+        // Returns true if any module listens to the hook. This doesn't go through the
+        // singleton accessor so it can guard the hot call sites of the core for free
+        static bool IsHookActive(ModuleHook hook)
+        {
+            const size_t index = static_cast<size_t>(hook);
+            return (activeHooks[index / 64] & (uint64(1) << (index % 64))) != 0;
+        }
+
+        // Periodic module tasks (see Module::RegisterTask)
+        uint32 RegisterTask(const Module* module, const std::string& taskName, uint32 interval, ModuleTaskCost cost, ModuleTaskCallback callback);
+        void RemoveTask(uint32 taskId);
+        // Time budget for the module tasks per world tick in microseconds
+        void SetUpdateBudget(uint32 budget) { scheduler.SetBudget(budget); }
+
+        // Config snapshots replaced by a reload get deleted after a few world ticks
+        void RetireConfig(ModuleConfig* config);
+        // Reloads the configuration of the given module (or all if empty). Returns the amount reloaded
+        uint32 ReloadConfigs(std::string_view moduleName);
+        // Reloads the configuration of the modules when their files change
+        void SetConfigWatch(bool enabled);
+
+        // Per player inventory index (see Module::UseInventoryIndex)
+        void EnableInventoryIndex();
+        const ModuleInventoryIndex* GetInventoryIndex(const Player* player) const { return inventoryIndex.GetIndex(player); }
+
+        // Per player module state (see Module::RegisterPlayerState). Returns null once a player has been loaded
+        const ModulePlayerStates* RegisterPlayerState(const Module* module, uint32 size, uint32 alignment, ModulePlayerStates::Constructor constructor, ModulePlayerStates::Destructor destructor, uint32& outOffset);
+
+        // Per creature module states (see ModuleCreatureState)
+        void RegisterCreatureState(ModuleCreatureStateBase* state);
+        void UnregisterCreatureState(ModuleCreatureStateBase* state);
+
+        // Memoized module chances (see Module::UseChanceCache)
+        void EnableChanceCache() { chanceCache.Enable(); }
+
+        // Module character queries (see Module::RegisterCharacterQuery)
+        uint32 RegisterCharacterQuery(const Module* module, const std::string& query);
+        // Adds the module character queries after the core ones into the login query holder
+        bool OnInitializeLoginQueryHolder(SqlQueryHolder* holder, uint32 playerId);
+
         // World Hooks
         void OnWorldPreInitialized();
         void OnWorldInitialized();
@@ -71,6 +134,7 @@ namespace cmangos_module
         void OnSellItem(Player* player, Item* item, uint32 money);
         void OnBuyBackItem(Player* player, Item* item, uint32 money);
         void OnCreateItem(Player* player, Item* item, uint32 amount);
+        void OnDestroyItem(Player* player, Item* item);
 
         // Player Gossip Hooks
         bool OnPreGossipHello(Player* player, const ObjectGuid& guid);
@@ -85,7 +149,7 @@ namespace cmangos_module
 
         // Player DB Hooks
         void OnPreLoadFromDB(Player* player);
-        void OnLoadFromDB(Player* player);
+        void OnLoadFromDB(Player* player, SqlQueryHolder* holder);
         void OnSaveToDB(Player* player);
         void OnDeleteFromDB(uint32 playerId);
 
@@ -155,6 +219,7 @@ namespace cmangos_module
         bool OnCalculateEffectiveCritChance(const Unit* unit, const Unit* victim, uint8 attType, const SpellEntry* ability, float& outChance);
         bool OnCalculateEffectiveMissChance(const Unit* unit, const Unit* victim, uint8 attType, const SpellEntry* ability, const Spell* const* currentSpells, const SpellPartialResistDistribution& spellPartialResistDistribution, float& outChance);
         bool OnCalculateSpellMissChance(const Unit* unit, const Unit* victim, uint32 schoolMask, const SpellEntry* spell, float& outChance);
+        void OnCalculateAttackTable(const Unit* attacker, const Unit* victim, uint8 attType, const SpellEntry* ability, ModuleAttackTable& table);
         bool OnGetAttackDistance(const Unit* unit, const Unit* target, float& outDistance);
         void OnDealDamage(Unit* unit, Unit* victim, uint32 health, uint32 damage);
         void OnKill(Unit* unit, Unit* victim);
@@ -208,10 +273,153 @@ namespace cmangos_module
         // Chat Commands
         bool OnExecuteCommand(ChatHandler* chatHandler, const std::string& cmd);
 
+    private:
+        // Builds the per hook dispatch lists from the hooks declared by each module
+        void BuildHookModules();
+        // Calls every module of a notify or out param hook in dispatch order
+        template<ModuleHook hook, typename Callback>
+        void DispatchHook(Callback callback);
+        // Calls the modules of an override hook until the callback returns true
+        template<ModuleHook hook, typename Callback>
+        bool DispatchOverrideHook(Callback callback);
+        static bool IsInventoryIndexHook(ModuleHook hook);
+        static bool IsAttackTableHook(ModuleHook hook);
+        static size_t GetSpellHookIndex(ModuleHook hook);
+        // Calls the modules of a spell hook that handle the spell, stopping when the callback returns true
+        template<typename Callback>
+        bool DispatchSpellHook(ModuleHook hook, const SpellEntry* spellInfo, Callback callback);
+        static size_t GetCreatureHookIndex(ModuleHook hook);
+        // Calls the modules of a creature hook that handle the creature, stopping when the callback returns true
+        template<typename Callback>
+        bool DispatchCreatureHook(ModuleHook hook, const Creature* creature, Callback callback);
+        // Calls a chance hook of a module through the chance cache if the module uses it
+        template<typename Callback>
+        bool CallChanceHook(Module* mod, ModuleHook hook, const Unit* unit, const Unit* target, uint32 variant, const SpellEntry* spellInfo, float& outChance, Callback callback);
+        // Gets the chance set by the OnCalculateAttackTable modules from the roll in progress (see ModuleAttackRoll)
+        bool GetAttackTableChance(const Unit* attacker, const Unit* victim, uint8 attType, const SpellEntry* ability, ModuleAttackOutcome outcome, float& outChance);
+        // Hooks dispatched through the compile time module set, which must hold every subscriber of the
+        // hook in dispatch order. Not used when profiling since it has no per module timers
+#if defined(MODULES_STATIC_DISPATCH) && !defined(MODULES_PROFILING)
+        bool IsStaticHook(ModuleHook hook) const { return staticHookMask.test(static_cast<size_t>(hook)); }
+#else
+        static constexpr bool IsStaticHook(ModuleHook hook) { return false; }
+#endif
+        bool IsHookDeferred(ModuleHook hook) const { return !deferredHookModules[static_cast<size_t>(hook)].empty(); }
+        // Delivers the queued events of the deferred hooks in one batch per hook
+        void DispatchDeferredEvents();
+        void UpdateRetiredConfigs();
+        void CheckConfigFiles();
+
+        // Logs the modules called by each hook in dispatch order
+        void LogHookOrder() const;
+        const std::vector<Module*>& GetHookModules(ModuleHook hook) const { return hookModules[static_cast<size_t>(hook)]; }
+
+        // Builds the lookup table of the module chat commands keyed by "prefix subcommand"
+        void BuildCommandTable();
+        void AddCommands(const std::string& path, const std::vector<ModuleChatCommand>& commandTable, std::vector<const ModuleChatCommand*>& chatCommands);
+
+        // Built-in ".modules" chat commands
+        bool HandleModulesCommand(ChatHandler* chatHandler, std::string_view subcommand, std::string_view args);
+
     private:
         std::vector<Module*> modules;
+        std::array<std::vector<Module*>, MODULE_HOOK_COUNT> hookModules;
+        std::array<std::vector<Module*>, MODULE_HOOK_COUNT> deferredHookModules;
+        const ModuleStaticHooks* staticHooks;
+        std::bitset<MODULE_HOOK_COUNT> staticHookMask;
+
+        struct SpellHookModules
+        {
+            // Modules that handle every spell, in dispatch order
+            std::vector<Module*> unfiltered;
+            // Every module of the hook in dispatch order with its filter (null if unfiltered)
+            std::vector<std::pair<Module*, const ModuleSpellFilter*>> subscribers;
+            // Union of the filters, the spells nobody filters on only go to the unfiltered modules
+            ModuleSpellFilter filter;
+        };
+
+        std::array<SpellHookModules, 4> spellHookModules;
+
+        struct CreatureHookModules
+        {
+            // Modules that handle every creature, in dispatch order
+            std::vector<Module*> unfiltered;
+            // Every module of the hook in dispatch order with its filter (null if unfiltered)
+            std::vector<std::pair<Module*, const ModuleCreatureFilter*>> subscribers;
+            // Union of the filters, the creatures nobody filters on only go to the unfiltered modules
+            ModuleCreatureFilter filter;
+        };
+
+        std::array<CreatureHookModules, 3> creatureHookModules;
+        static uint64 activeHooks[(MODULE_HOOK_COUNT + 63) / 64];
+        ModuleScheduler scheduler;
+        std::vector<ModuleCharacterQuery> characterQueries;
+        ModuleInventoryIndexMgr inventoryIndex;
+        ModulePlayerStates playerStates;
+        std::vector<ModuleCreatureStateBase*> creatureStates;
+        uint32 creatureStateSweepTimer;
+        ModuleEventQueue events;
+        ModuleChanceCache chanceCache;
+        std::array<std::vector<ModuleEvent>, MODULE_HOOK_COUNT> eventBatches;
+
+        struct RetiredConfig
+        {
+            ModuleConfig* config;
+            uint32 ticks;
+        };
+
+        std::mutex retiredConfigsLock;
+        std::vector<RetiredConfig> retiredConfigs;
+        std::vector<std::filesystem::file_time_type> configFileTimes;
+        uint32 configWatchTask;
+        std::vector<std::string> commandKeys;
+        struct CommandEntry
+        {
+            const ModuleChatCommand* command;
+            std::string usage;
+        };
+
+        std::unordered_map<std::string_view, CommandEntry> commands;
+
+#ifdef MODULES_PROFILING
+        ModuleProfiler profiler;
+#endif
+    };
+
+    // Attack table of the roll in progress on the thread. The core creates it on the stack where it rolls
+    // the outcome of an attack, so the OnCalculateAttackTable modules are called once per roll and the
+    // chance hooks called by the roll read their chances from it
+    class ModuleAttackRoll
+    {
+    public:
+        ModuleAttackRoll(const Unit* attacker, const Unit* victim, uint8 attType, const SpellEntry* ability);
+        ~ModuleAttackRoll();
+
+        ModuleAttackRoll(const ModuleAttackRoll&) = delete;
+        ModuleAttackRoll& operator=(const ModuleAttackRoll&) = delete;
+
+        // Innermost roll of the thread, null outside of a roll
+        static const ModuleAttackRoll* GetCurrent() { return current; }
+
+        bool IsFor(const Unit* attacker, const Unit* victim, uint8 attType, const SpellEntry* ability) const
+        {
+            return this->attacker == attacker && this->victim == victim && this->attType == attType && this->ability == ability;
+        }
+
+        const ModuleAttackTable& GetTable() const { return table; }
+
+    private:
+        const Unit* attacker;
+        const Unit* victim;
+        const SpellEntry* ability;
+        uint8 attType;
+        ModuleAttackTable table;
+        const ModuleAttackRoll* previous;
+
+        static thread_local const ModuleAttackRoll* current;
     };
 }
 
 #define sModuleMgr MaNGOS::Singleton<cmangos_module::ModuleMgr>::Instance()
+#define sModuleHookActive(hook) cmangos_module::ModuleMgr::IsHookActive(cmangos_module::ModuleHook::hook)
 #endif
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "ModulePlayerState.h"
+
+#include "Entities/Player.h"
+#include "Log/Log.h"
+
+#include <algorithm>
+
+namespace cmangos_module
+{
+    // Blocks start and end on a cache line
+    constexpr uint32 MODULE_PLAYER_STATE_CACHE_LINE = 64;
+
+    ModulePlayerStates::ModulePlayerStates()
+    : blockSize(0)
+    , blockAlignment(MODULE_PLAYER_STATE_CACHE_LINE)
+    , frozen(false)
+    , chunks()
+    , chunkCount(0)
+    , blockCount(0)
+    {
+    }
+
+    ModulePlayerStates::~ModulePlayerStates()
+    {
+        for (uint32 i = 0; i < chunkCount; ++i)
+        {
+            ::operator delete(chunks[i], std::align_val_t(blockAlignment));
+            chunks[i] = nullptr;
+        }
+    }
+
+    bool ModulePlayerStates::AddSlot(uint32 size, uint32 alignment, Constructor constructor, Destructor destructor, uint32& outOffset)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (frozen)
+        {
+            return false;
+        }
+
+        // Slots are packed in registration order, each one at its own alignment
+        outOffset = (blockSize + alignment - 1) / alignment * alignment;
+        blockSize = outOffset + size;
+        blockAlignment = std::max(blockAlignment, alignment);
+        slots.push_back({ outOffset, constructor, destructor });
+        return true;
+    }
+
+    void ModulePlayerStates::OnLoad(Player* player)
+    {
+        if (!player)
+        {
+            return;
+        }
+
+        uint32 index = 0;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!frozen)
+            {
+                // The layout can't change once a block exists
+                frozen = true;
+                blockSize = (std::max(blockSize, 1U) + blockAlignment - 1) / blockAlignment * blockAlignment;
+            }
+
+            if (slots.empty() || player->GetModuleStateIndex())
+            {
+                return;
+            }
+
+            if (!freeBlocks.empty())
+            {
+                index = freeBlocks.back();
+                freeBlocks.pop_back();
+            }
+            else
+            {
+                if (blockCount == chunkCount * MODULE_PLAYER_STATE_CHUNK_SIZE)
+                {
+                    if (chunkCount == MODULE_PLAYER_STATE_MAX_CHUNKS)
+                    {
+                        sLog.outError("Module player states: no room for the state of player %u", player->GetObjectGuid().GetCounter());
+                        return;
+                    }
+
+                    chunks[chunkCount++] = static_cast<uint8*>(::operator new(size_t(blockSize) * MODULE_PLAYER_STATE_CHUNK_SIZE, std::align_val_t(blockAlignment)));
+                }
+
+                index = blockCount++;
+            }
+        }
+
+        uint8* block = GetBlock(index);
+        for (const Slot& slot : slots)
+        {
+            slot.constructor(block + slot.offset);
+        }
+
+        // The index is stored off by one so 0 means no state
+        player->SetModuleStateIndex(index + 1);
+    }
+
+    void ModulePlayerStates::OnLogOut(Player* player)
+    {
+        const uint32 stateIndex = player ? player->GetModuleStateIndex() : 0;
+        if (!stateIndex)
+        {
+            return;
+        }
+
+        const uint32 index = stateIndex - 1;
+        uint8* block = GetBlock(index);
+        for (auto slotIt = slots.rbegin(); slotIt != slots.rend(); ++slotIt)
+        {
+            slotIt->destructor(block + slotIt->offset);
+        }
+
+        player->SetModuleStateIndex(0);
+
+        std::lock_guard<std::mutex> guard(lock);
+        freeBlocks.push_back(index);
+    }
+
+    void* ModulePlayerStates::Get(const Player* player, uint32 offset) const
+    {
+        const uint32 stateIndex = player ? player->GetModuleStateIndex() : 0;
+        return stateIndex ? GetBlock(stateIndex - 1) + offset : nullptr;
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef CMANGOS_MODULE_PLAYER_STATE_H
+#define CMANGOS_MODULE_PLAYER_STATE_H
+
+#include "Platform/Define.h"
+
+#include <array>
+#include <mutex>
+#include <new>
+#include <vector>
+
+class Player;
+
+namespace cmangos_module
+{
+    // Player states allocated together in a slab chunk
+    constexpr uint32 MODULE_PLAYER_STATE_CHUNK_SIZE = 64;
+    // Chunks a slab can grow to, which limits the amount of players with a state
+    constexpr uint32 MODULE_PLAYER_STATE_MAX_CHUNKS = 1024;
+
+    class ModulePlayerStates;
+
+    // Handle of a typed slot of the module state of every player (see Module::RegisterPlayerState)
+    template<typename T>
+    class ModulePlayerSlot
+    {
+    public:
+        ModulePlayerSlot() : states(nullptr), offset(0) {}
+        ModulePlayerSlot(const ModulePlayerStates* states, uint32 offset) : states(states), offset(offset) {}
+
+        // State of the player, null if the player hasn't been loaded or the slot is invalid
+        T* Get(const Player* player) const;
+        bool IsValid() const { return states != nullptr; }
+
+    private:
+        const ModulePlayerStates* states;
+        uint32 offset;
+    };
+
+    // Module state of the online players. The slots registered by the modules are laid out in a
+    // single block per player, allocated from a slab when the player loads and released in one go
+    // when it logs out. The player keeps the index of its block so a slot is reached without lookups
+    class ModulePlayerStates
+    {
+    public:
+        typedef void (*Constructor)(void* data);
+        typedef void (*Destructor)(void* data);
+
+        ModulePlayerStates();
+        ~ModulePlayerStates();
+
+        ModulePlayerStates(const ModulePlayerStates&) = delete;
+        ModulePlayerStates& operator=(const ModulePlayerStates&) = delete;
+
+        // Adds a slot to the block of every player. Returns false once a player has been loaded
+        bool AddSlot(uint32 size, uint32 alignment, Constructor constructor, Destructor destructor, uint32& outOffset);
+        bool HasSlots() const { return !slots.empty(); }
+
+        // Constructs the slots of the player, called before the modules get OnLoadFromDB
+        void OnLoad(Player* player);
+        // Destroys the slots of the player, called after the modules got OnLogOut
+        void OnLogOut(Player* player);
+
+        // Slot data of the player, null if the player has no block
+        void* Get(const Player* player, uint32 offset) const;
+
+    private:
+        uint8* GetBlock(uint32 index) const { return chunks[index / MODULE_PLAYER_STATE_CHUNK_SIZE] + (index % MODULE_PLAYER_STATE_CHUNK_SIZE) * blockSize; }
+
+    private:
+        struct Slot
+        {
+            uint32 offset;
+            Constructor constructor;
+            Destructor destructor;
+        };
+
+        std::vector<Slot> slots;
+        // Blocks are padded to whole cache lines so players updated by different maps don't share them
+        uint32 blockSize;
+        uint32 blockAlignment;
+        bool frozen;
+
+        // Chunks never move, a block keeps its address until its player logs out
+        std::array<uint8*, MODULE_PLAYER_STATE_MAX_CHUNKS> chunks;
+        uint32 chunkCount;
+        uint32 blockCount;
+        std::vector<uint32> freeBlocks;
+        std::mutex lock;
+    };
+
+    template<typename T>
+    T* ModulePlayerSlot<T>::Get(const Player* player) const
+    {
+        return states ? static_cast<T*>(states->Get(player, offset)) : nullptr;
+    }
+}
+
+#endif
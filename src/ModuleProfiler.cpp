@@ -0,0 +1,227 @@
+#include "ModuleProfiler.h"
+#include "Module.h"
+
+#include "Chat/Chat.h"
+#include "Log/Log.h"
+
+#ifdef BUILD_METRICS
+#include "Metric/Metric.h"
+#endif
+
+#include <algorithm>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define MODULE_PROFILER_USE_TSC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define MODULE_PROFILER_USE_TSC
+#endif
+
+namespace cmangos_module
+{
+    uint64 GetModuleProfilerTicks()
+    {
+#ifdef MODULE_PROFILER_USE_TSC
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    void ModuleHookStats::Reset()
+    {
+        calls.store(0, std::memory_order_relaxed);
+        totalTime.store(0, std::memory_order_relaxed);
+        maxTime.store(0, std::memory_order_relaxed);
+        for (std::atomic<uint32>& bucket : histogram)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void ModuleHookStats::Record(uint64 elapsed)
+    {
+        calls.fetch_add(1, std::memory_order_relaxed);
+        totalTime.fetch_add(elapsed, std::memory_order_relaxed);
+
+        uint64 currentMax = maxTime.load(std::memory_order_relaxed);
+        while (elapsed > currentMax && !maxTime.compare_exchange_weak(currentMax, elapsed, std::memory_order_relaxed)) {}
+
+        uint32 bucket = 0;
+        for (uint64 value = elapsed >> (MODULE_PROFILER_HISTOGRAM_FIRST_BIT + 1); value && bucket < MODULE_PROFILER_HISTOGRAM_BUCKETS - 1; value >>= 1)
+        {
+            ++bucket;
+        }
+
+        histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ModuleProfiler::ModuleProfiler()
+    : startTicks(GetModuleProfilerTicks())
+    , startTime(std::chrono::steady_clock::now())
+    , dumpInterval(5 * MINUTE * IN_MILLISECONDS)
+    , dumpTimer(0)
+    {
+
+    }
+
+    double ModuleProfiler::TicksToNanoseconds(uint64 ticks) const
+    {
+#ifdef MODULE_PROFILER_USE_TSC
+        // Calibrate the time stamp counter against the steady clock over the profiler lifetime
+        const double elapsedTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+        const uint64 elapsedTicks = GetModuleProfilerTicks() - startTicks;
+        return elapsedTicks ? ticks * (elapsedTime / elapsedTicks) : 0.0;
+#else
+        return double(ticks);
+#endif
+    }
+
+    void ModuleProfiler::Initialize(const std::vector<Module*>& modules)
+    {
+        moduleNames.clear();
+        for (const Module* mod : modules)
+        {
+            moduleNames.push_back(mod->GetName());
+        }
+
+        stats = std::vector<std::array<ModuleHookStats, MODULE_HOOK_COUNT>>(modules.size());
+        Reset();
+    }
+
+    void ModuleProfiler::Reset()
+    {
+        for (auto& moduleStats : stats)
+        {
+            for (ModuleHookStats& hookStats : moduleStats)
+            {
+                hookStats.Reset();
+            }
+        }
+
+        dumpTimer = 0;
+    }
+
+    void ModuleProfiler::Update(uint32 elapsed)
+    {
+        if (dumpInterval)
+        {
+            dumpTimer += elapsed;
+            if (dumpTimer >= dumpInterval)
+            {
+                dumpTimer = 0;
+                Dump();
+            }
+        }
+    }
+
+    std::vector<ModuleProfiler::Entry> ModuleProfiler::GetSortedEntries() const
+    {
+        std::vector<Entry> entries;
+        for (uint32 moduleId = 0; moduleId < stats.size(); ++moduleId)
+        {
+            for (size_t i = 0; i < MODULE_HOOK_COUNT; ++i)
+            {
+                const ModuleHookStats& hookStats = stats[moduleId][i];
+                const uint64 calls = hookStats.calls.load(std::memory_order_relaxed);
+                if (calls)
+                {
+                    entries.push_back({ moduleId, static_cast<ModuleHook>(i), calls, hookStats.totalTime.load(std::memory_order_relaxed), hookStats.maxTime.load(std::memory_order_relaxed) });
+                }
+            }
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.totalTime > b.totalTime; });
+        return entries;
+    }
+
+    uint64 ModuleProfiler::GetPercentile(uint32 moduleId, ModuleHook hook, float percentile) const
+    {
+        const ModuleHookStats& hookStats = stats[moduleId][static_cast<size_t>(hook)];
+
+        uint64 total = 0;
+        for (const std::atomic<uint32>& bucket : hookStats.histogram)
+        {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+
+        // Returns the upper bound (in ticks) of the bucket that contains the percentile
+        uint64 accumulated = 0;
+        for (uint32 i = 0; i < MODULE_PROFILER_HISTOGRAM_BUCKETS; ++i)
+        {
+            accumulated += hookStats.histogram[i].load(std::memory_order_relaxed);
+            if (total && accumulated >= total * percentile)
+            {
+                return uint64(1) << (i + MODULE_PROFILER_HISTOGRAM_FIRST_BIT + 1);
+            }
+        }
+
+        return hookStats.maxTime.load(std::memory_order_relaxed);
+    }
+
+    void ModuleProfiler::Print(ChatHandler* chatHandler, uint32 count) const
+    {
+        const std::vector<Entry> entries = GetSortedEntries();
+        if (entries.empty())
+        {
+            chatHandler->SendSysMessage("No module hook calls recorded");
+            return;
+        }
+
+        chatHandler->SendSysMessage("Module | Hook | Calls | Total ms | Avg us | P99 us | Max us");
+        for (uint32 i = 0; i < entries.size() && i < count; ++i)
+        {
+            const Entry& entry = entries[i];
+            const double totalTime = TicksToNanoseconds(entry.totalTime);
+            chatHandler->PSendSysMessage("%s | %s | %llu | %.3f | %.3f | %.3f | %.3f",
+                moduleNames[entry.moduleId].c_str(),
+                GetModuleHookName(entry.hook),
+                (unsigned long long)entry.calls,
+                totalTime / 1000000.0,
+                totalTime / 1000.0 / entry.calls,
+                TicksToNanoseconds(GetPercentile(entry.moduleId, entry.hook, 0.99f)) / 1000.0,
+                TicksToNanoseconds(entry.maxTime) / 1000.0);
+        }
+    }
+
+    void ModuleProfiler::Dump() const
+    {
+        const std::vector<Entry> entries = GetSortedEntries();
+        for (uint32 i = 0; i < entries.size(); ++i)
+        {
+            const Entry& entry = entries[i];
+            const char* moduleName = moduleNames[entry.moduleId].c_str();
+            const char* hookName = GetModuleHookName(entry.hook);
+            const double totalTime = TicksToNanoseconds(entry.totalTime);
+            const double maxTime = TicksToNanoseconds(entry.maxTime);
+
+            // Only the most expensive entries go into the log, metrics get everything
+            if (i < 10)
+            {
+                sLog.outString("Module profiler: %s::%s calls %llu total %.3fms avg %.3fus max %.3fus",
+                    moduleName, hookName, (unsigned long long)entry.calls, totalTime / 1000000.0, totalTime / 1000.0 / entry.calls, maxTime / 1000.0);
+            }
+
+#ifdef BUILD_METRICS
+            metric::measurement meas("modules.hooks", { { "module", moduleName }, { "hook", hookName } });
+            meas.add_field("calls", std::to_string(entry.calls));
+            meas.add_field("total_ns", std::to_string(uint64(totalTime)));
+            meas.add_field("max_ns", std::to_string(uint64(maxTime)));
+            meas.add_field("p99_ns", std::to_string(uint64(TicksToNanoseconds(GetPercentile(entry.moduleId, entry.hook, 0.99f)))));
+#endif
+        }
+    }
+
+    ModuleHookTimer::ModuleHookTimer(ModuleProfiler& profiler, const Module* mod, ModuleHook hook)
+    : stats(profiler.GetStats(mod->GetId(), hook))
+    , start(GetModuleProfilerTicks())
+    {
+
+    }
+
+    ModuleHookTimer::~ModuleHookTimer()
+    {
+        stats.Record(GetModuleProfilerTicks() - start);
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef CMANGOS_MODULE_PROFILER_H
+#define CMANGOS_MODULE_PROFILER_H
+
+#include "Platform/Define.h"
+#include "ModuleHook.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+class ChatHandler;
+
+namespace cmangos_module
+{
+    class Module;
+
+    // Latency histogram buckets double in size: bucket 0 holds calls under 256 ticks,
+    // bucket N holds [2^(N+7), 2^(N+8)) ticks and the last one everything above
+    constexpr uint32 MODULE_PROFILER_HISTOGRAM_BUCKETS = 14;
+    constexpr uint32 MODULE_PROFILER_HISTOGRAM_FIRST_BIT = 7;
+    // Entries ".modules profile <count>" prints at most
+    constexpr uint32 MODULE_PROFILER_MAX_PRINT_COUNT = 100;
+
+    // Cheap timestamp source for the hook timers. Uses the CPU time stamp counter
+    // where available and gets converted to nanoseconds only when reporting
+    uint64 GetModuleProfilerTicks();
+
+    struct ModuleHookStats
+    {
+        std::atomic<uint64> calls;
+        std::atomic<uint64> totalTime;
+        std::atomic<uint64> maxTime;
+        std::array<std::atomic<uint32>, MODULE_PROFILER_HISTOGRAM_BUCKETS> histogram;
+
+        void Reset();
+        void Record(uint64 elapsed);
+    };
+
+    // Collects call counts and wall time per (module, hook) pair for the dispatch
+    // loops of ModuleMgr. Only used when building with MODULES_PROFILING
+    class ModuleProfiler
+    {
+    public:
+        ModuleProfiler();
+
+        void Initialize(const std::vector<Module*>& modules);
+        void Reset();
+
+        ModuleHookStats& GetStats(uint32 moduleId, ModuleHook hook) { return stats[moduleId][static_cast<size_t>(hook)]; }
+
+        // Periodically dumps the collected data into the log and metrics
+        void Update(uint32 elapsed);
+        void SetDumpInterval(uint32 interval) { dumpInterval = interval; }
+
+        // Prints the most expensive (module, hook) pairs into the chat
+        void Print(ChatHandler* chatHandler, uint32 count) const;
+
+    private:
+        struct Entry
+        {
+            uint32 moduleId;
+            ModuleHook hook;
+            uint64 calls;
+            uint64 totalTime;
+            uint64 maxTime;
+        };
+
+        std::vector<Entry> GetSortedEntries() const;
+        uint64 GetPercentile(uint32 moduleId, ModuleHook hook, float percentile) const;
+        double TicksToNanoseconds(uint64 ticks) const;
+        void Dump() const;
+
+    private:
+        std::vector<std::string> moduleNames;
+        uint64 startTicks;
+        std::chrono::steady_clock::time_point startTime;
+        std::vector<std::array<ModuleHookStats, MODULE_HOOK_COUNT>> stats;
+        uint32 dumpInterval;
+        uint32 dumpTimer;
+    };
+
+    // Measures the wall time of a single module hook call
+    class ModuleHookTimer
+    {
+    public:
+        ModuleHookTimer(ModuleProfiler& profiler, const Module* mod, ModuleHook hook);
+        ~ModuleHookTimer();
+
+    private:
+        ModuleHookStats& stats;
+        uint64 start;
+    };
+}
+
+#ifdef MODULES_PROFILING
+#define MODULE_PROFILE_HOOK(mod, hook) cmangos_module::ModuleHookTimer moduleHookTimer(profiler, mod, hook)
+#else
+#define MODULE_PROFILE_HOOK(mod, hook)
+#endif
+
+#endif
@@ -0,0 +1,28 @@
+#include "ModuleQuery.h"
+
+namespace cmangos_module
+{
+    ModuleCharacterQuery::ModuleCharacterQuery(uint32 moduleId, const std::string& query)
+    : moduleId(moduleId)
+    , valid(false)
+    {
+        // The character guid is the only allowed argument and must appear once as %u
+        const size_t placeholder = query.find("%u");
+        if (placeholder != std::string::npos)
+        {
+            prefix = query.substr(0, placeholder);
+            suffix = query.substr(placeholder + 2);
+            valid = prefix.find('%') == std::string::npos && suffix.find('%') == std::string::npos;
+        }
+    }
+
+    std::string ModuleCharacterQuery::Format(uint32 playerId) const
+    {
+        std::string query;
+        query.reserve(prefix.size() + suffix.size() + 10);
+        query.append(prefix);
+        query.append(std::to_string(playerId));
+        query.append(suffix);
+        return query;
+    }
+}
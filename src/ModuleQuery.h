@@ -0,0 +1,49 @@
+#ifndef CMANGOS_MODULE_QUERY_H
+#define CMANGOS_MODULE_QUERY_H
+
+#include "Platform/Define.h"
+#include "Database/DatabaseEnv.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cmangos_module
+{
+    // Per character query registered by a module at startup. The query gets added into
+    // the core login query holder so it runs together with the core ones
+    class ModuleCharacterQuery
+    {
+    public:
+        ModuleCharacterQuery(uint32 moduleId, const std::string& query);
+
+        bool IsValid() const { return valid; }
+        uint32 GetModuleId() const { return moduleId; }
+
+        // Returns the query with the guid placeholder replaced
+        std::string Format(uint32 playerId) const;
+
+    private:
+        uint32 moduleId;
+        std::string prefix;
+        std::string suffix;
+        bool valid;
+    };
+
+    // Results of the character queries of a module, in registration order
+    class ModuleQueryResults
+    {
+    public:
+        void Add(std::unique_ptr<QueryResult> result) { results.push_back(std::move(result)); }
+        void Clear() { results.clear(); }
+
+        // Returns nullptr if the query didn't return any row
+        QueryResult* GetResult(uint32 queryId) const { return queryId < results.size() ? results[queryId].get() : nullptr; }
+        uint32 GetSize() const { return static_cast<uint32>(results.size()); }
+
+    private:
+        std::vector<std::unique_ptr<QueryResult>> results;
+    };
+}
+
+#endif
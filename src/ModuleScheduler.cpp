@@ -0,0 +1,223 @@
+#include "ModuleScheduler.h"
+#include "Module.h"
+
+#include "Chat/Chat.h"
+#include "Log/Log.h"
+
+#ifdef BUILD_METRICS
+#include "Metric/Metric.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+
+namespace cmangos_module
+{
+    // Default time budget per world tick for the module tasks (microseconds)
+    constexpr uint32 MODULE_SCHEDULER_DEFAULT_BUDGET = 2000;
+    // Times a task can be deferred before it runs regardless of the budget
+    constexpr uint32 MODULE_SCHEDULER_MAX_DEFERRALS = 10;
+    // Share of the tick budget the medium tasks can use together (1 / n)
+    constexpr uint32 MODULE_SCHEDULER_MEDIUM_SHARE = 2;
+    // Number of phases used to spread the first run of the tasks with the same interval
+    constexpr uint32 MODULE_SCHEDULER_PHASES = 8;
+
+    ModuleScheduler::ModuleScheduler()
+    : nextTaskId(1)
+    , budget(MODULE_SCHEDULER_DEFAULT_BUDGET)
+    , overrunTicks(0)
+    , updating(false)
+    {
+
+    }
+
+    uint32 ModuleScheduler::AddTask(const Module* owner, const std::string& name, uint32 interval, ModuleTaskCost cost, ModuleTaskCallback callback)
+    {
+        if (!callback)
+        {
+            return 0;
+        }
+
+        Task task;
+        task.id = nextTaskId++;
+        task.owner = owner;
+        task.name = name;
+        task.interval = std::max(interval, 1U);
+        task.cost = cost;
+        task.callback = std::move(callback);
+        task.removed = false;
+        // Spread the tasks across ticks so the ones with the same interval don't run together
+        task.timer = (task.interval / MODULE_SCHEDULER_PHASES) * (task.id % MODULE_SCHEDULER_PHASES);
+        task.deferrals = 0;
+        task.runs = 0;
+        task.totalDeferrals = 0;
+        task.overruns = 0;
+        task.totalTime = 0;
+        task.maxTime = 0;
+
+        if (updating)
+        {
+            pendingTasks.push_back(std::move(task));
+        }
+        else
+        {
+            tasks.push_back(std::move(task));
+        }
+
+        return nextTaskId - 1;
+    }
+
+    void ModuleScheduler::RemoveTask(uint32 taskId)
+    {
+        // A task can remove itself from its callback, so it only gets erased on the next update
+        for (Task& task : tasks)
+        {
+            if (task.id == taskId)
+            {
+                task.removed = true;
+            }
+        }
+
+        pendingTasks.erase(std::remove_if(pendingTasks.begin(), pendingTasks.end(), [taskId](const Task& task) { return task.id == taskId; }), pendingTasks.end());
+    }
+
+    bool ModuleScheduler::IsForced(const Task& task) const
+    {
+        return task.deferrals >= MODULE_SCHEDULER_MAX_DEFERRALS;
+    }
+
+    void ModuleScheduler::Update(uint32 elapsed)
+    {
+        tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [](const Task& task) { return task.removed; }), tasks.end());
+
+        dueTasks.clear();
+        for (Task& task : tasks)
+        {
+            task.timer += elapsed;
+            if (IsDue(task))
+            {
+                dueTasks.push_back(&task);
+            }
+        }
+
+        if (dueTasks.empty())
+        {
+            return;
+        }
+
+        // Forced tasks go first, then the ones that are most late relative to their interval
+        std::sort(dueTasks.begin(), dueTasks.end(), [this](const Task* a, const Task* b)
+        {
+            if (IsForced(*a) != IsForced(*b))
+            {
+                return IsForced(*a);
+            }
+
+            return uint64(a->timer) * b->interval > uint64(b->timer) * a->interval;
+        });
+
+        updating = true;
+
+        const auto tickStart = std::chrono::steady_clock::now();
+        uint64 usedTime = 0;
+        uint64 mediumTime = 0;
+        uint32 deferred = 0;
+        bool heavyTaskRan = false;
+        bool overrun = false;
+        for (Task* task : dueTasks)
+        {
+            if (task->removed)
+            {
+                continue;
+            }
+
+            if (!IsForced(*task))
+            {
+                const bool heavy = task->cost == ModuleTaskCost::Heavy;
+                const bool fits = usedTime == 0 || usedTime + GetAverageTime(*task) <= budget;
+                const bool mediumFits = task->cost != ModuleTaskCost::Medium || mediumTime == 0 || mediumTime + GetAverageTime(*task) <= budget / MODULE_SCHEDULER_MEDIUM_SHARE;
+                if (!fits || !mediumFits || (heavy && heavyTaskRan))
+                {
+                    ++task->deferrals;
+                    ++task->totalDeferrals;
+                    ++deferred;
+                    continue;
+                }
+            }
+
+            const auto taskStart = std::chrono::steady_clock::now();
+            task->callback(task->timer);
+            const auto taskEnd = std::chrono::steady_clock::now();
+
+            const uint64 taskTime = std::chrono::duration_cast<std::chrono::microseconds>(taskEnd - taskStart).count();
+            task->runs++;
+            task->totalTime += taskTime;
+            task->maxTime = std::max(task->maxTime, taskTime);
+            task->timer = 0;
+            task->deferrals = 0;
+
+            heavyTaskRan |= task->cost == ModuleTaskCost::Heavy;
+            if (task->cost == ModuleTaskCost::Medium)
+            {
+                mediumTime += taskTime;
+            }
+
+            usedTime = std::chrono::duration_cast<std::chrono::microseconds>(taskEnd - tickStart).count();
+            if (usedTime > budget)
+            {
+                // The task that exceeded the budget gets the blame
+                ++task->overruns;
+                overrun = true;
+            }
+        }
+
+        updating = false;
+
+        if (overrun)
+        {
+            ++overrunTicks;
+        }
+
+        for (Task& task : pendingTasks)
+        {
+            tasks.push_back(std::move(task));
+        }
+
+        pendingTasks.clear();
+
+#ifdef BUILD_METRICS
+        metric::measurement meas("modules.scheduler");
+        meas.add_field("time_us", std::to_string(usedTime));
+        meas.add_field("budget_us", std::to_string(budget));
+        meas.add_field("deferred", std::to_string(deferred));
+        meas.add_field("overrun", std::to_string(overrun ? 1 : 0));
+#endif
+    }
+
+    void ModuleScheduler::Print(ChatHandler* chatHandler) const
+    {
+        if (tasks.empty())
+        {
+            chatHandler->SendSysMessage("No module tasks registered");
+            return;
+        }
+
+        chatHandler->PSendSysMessage("Budget %u us per tick, %llu ticks over budget", budget, (unsigned long long)overrunTicks);
+        chatHandler->SendSysMessage("Module | Task | Interval ms | Runs | Deferrals | Overruns | Avg us | Max us");
+        for (const Task& task : tasks)
+        {
+            if (!task.removed)
+            {
+                chatHandler->PSendSysMessage("%s | %s | %u | %llu | %llu | %llu | %llu | %llu",
+                    task.owner ? task.owner->GetName().c_str() : "",
+                    task.name.c_str(),
+                    task.interval,
+                    (unsigned long long)task.runs,
+                    (unsigned long long)task.totalDeferrals,
+                    (unsigned long long)task.overruns,
+                    (unsigned long long)GetAverageTime(task),
+                    (unsigned long long)task.maxTime);
+            }
+        }
+    }
+}
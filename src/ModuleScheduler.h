@@ -0,0 +1,86 @@
+#ifndef CMANGOS_MODULE_SCHEDULER_H
+#define CMANGOS_MODULE_SCHEDULER_H
+
+#include "Platform/Define.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class ChatHandler;
+
+namespace cmangos_module
+{
+    class Module;
+
+    // Rough cost of a periodic task. Light tasks run while the tick budget lasts, medium tasks
+    // together only get half of it so they don't delay the light ones, and only one heavy task
+    // is allowed to run per world tick
+    enum class ModuleTaskCost : uint8
+    {
+        Light,
+        Medium,
+        Heavy
+    };
+
+    typedef std::function<void(uint32)> ModuleTaskCallback;
+
+    // Runs the periodic tasks registered by the modules from the world update, spreading
+    // them across ticks and deferring whatever doesn't fit into the per tick time budget
+    class ModuleScheduler
+    {
+    public:
+        ModuleScheduler();
+
+        uint32 AddTask(const Module* owner, const std::string& name, uint32 interval, ModuleTaskCost cost, ModuleTaskCallback callback);
+        void RemoveTask(uint32 taskId);
+
+        // Time budget per world tick in microseconds
+        void SetBudget(uint32 budget) { this->budget = budget; }
+        uint32 GetBudget() const { return budget; }
+
+        void Update(uint32 elapsed);
+
+        // Prints the task statistics into the chat
+        void Print(ChatHandler* chatHandler) const;
+
+    private:
+        struct Task
+        {
+            uint32 id;
+            const Module* owner;
+            std::string name;
+            uint32 interval;
+            ModuleTaskCost cost;
+            ModuleTaskCallback callback;
+            // Removed tasks keep their callback, which may be running, until the next update erases them
+            bool removed;
+
+            // Time since the task last ran (ms)
+            uint32 timer;
+            uint32 deferrals;
+
+            uint64 runs;
+            uint64 totalDeferrals;
+            uint64 overruns;
+            uint64 totalTime;
+            uint64 maxTime;
+        };
+
+        bool IsDue(const Task& task) const { return task.timer >= task.interval; }
+        bool IsForced(const Task& task) const;
+        uint64 GetAverageTime(const Task& task) const { return task.runs ? task.totalTime / task.runs : 0; }
+
+    private:
+        std::vector<Task> tasks;
+        // Tasks added while updating get moved into the task list after the update
+        std::vector<Task> pendingTasks;
+        std::vector<Task*> dueTasks;
+        uint32 nextTaskId;
+        uint32 budget;
+        uint64 overrunTicks;
+        bool updating;
+    };
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef CMANGOS_MODULE_SPELL_FILTER_H
+#define CMANGOS_MODULE_SPELL_FILTER_H
+
+#include "Platform/Define.h"
+#include "ModuleHook.h"
+
+#include <vector>
+
+namespace cmangos_module
+{
+    // Hooks that can be filtered by spell (see Module::RegisterSpellHook)
+    inline bool IsModuleSpellHook(ModuleHook hook)
+    {
+        return hook == ModuleHook::OnCast || hook == ModuleHook::OnHit || hook == ModuleHook::OnProc || hook == ModuleHook::OnPeriodicTick;
+    }
+
+    // Set of spell ids and spell families a module handles on a spell hook, kept as a bitset
+    // over the spell ids so checking a spell is a couple of instructions
+    class ModuleSpellFilter
+    {
+    public:
+        ModuleSpellFilter() : families(0) {}
+
+        void AddSpell(uint32 spellId)
+        {
+            const size_t word = spellId / 64;
+            if (word >= spells.size())
+            {
+                spells.resize(word + 1, 0);
+            }
+
+            spells[word] |= uint64(1) << (spellId % 64);
+        }
+
+        // Spell families go from 0 (generic) to the last class family, all below 64
+        void AddFamily(uint32 family)
+        {
+            if (family < 64)
+            {
+                families |= uint64(1) << family;
+            }
+        }
+
+        void Merge(const ModuleSpellFilter& filter)
+        {
+            if (filter.spells.size() > spells.size())
+            {
+                spells.resize(filter.spells.size(), 0);
+            }
+
+            for (size_t i = 0; i < filter.spells.size(); ++i)
+            {
+                spells[i] |= filter.spells[i];
+            }
+
+            families |= filter.families;
+        }
+
+        bool HasSpell(uint32 spellId) const
+        {
+            const size_t word = spellId / 64;
+            return word < spells.size() && (spells[word] & (uint64(1) << (spellId % 64))) != 0;
+        }
+
+        bool HasFamily(uint32 family) const { return family < 64 && (families & (uint64(1) << family)) != 0; }
+        bool Matches(uint32 spellId, uint32 family) const { return HasSpell(spellId) || HasFamily(family); }
+        bool IsEmpty() const { return spells.empty() && !families; }
+
+    private:
+        std::vector<uint64> spells;
+        uint64 families;
+    };
+}
+
+#endif
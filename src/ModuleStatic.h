@@ -0,0 +1,197 @@
+#ifndef CMANGOS_MODULE_STATIC_H
+#define CMANGOS_MODULE_STATIC_H
+
+#include "Module.h"
+
+#include <array>
+#include <bitset>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+// True if the module class implements the hook. The member pointer of a hook that the class
+// doesn't override still belongs to Module (only for hooks without overloads)
+#define MODULE_OVERRIDES_HOOK(ModuleType, hook) (!std::is_same<decltype(&ModuleType::hook), decltype(&Module::hook)>::value)
+
+namespace cmangos_module
+{
+    // Dispatch functions of the hot hooks generated for the modules known at compile time
+    // (BUILD_MODULES_STATIC_DISPATCH). They call the module classes directly instead of through
+    // the vtable, so the hook bodies get inlined and the modules without the hook cost nothing
+    struct ModuleStaticHooks
+    {
+        void (*OnRegenerate)(Player* player, uint8 power, uint32 diff, float& addedValue);
+        bool (*OnGetAttackDistance)(const Unit* unit, const Unit* target, float& outDistance);
+        void (*OnDealDamage)(Unit* unit, Unit* victim, uint32 health, uint32 damage);
+        void (*OnKill)(Unit* unit, Unit* victim);
+        void (*OnDealHeal)(Unit* unit, Unit* victim, int32 gain, uint32 addHealth);
+        void (*OnSetPower)(Unit* unit, uint8 power, uint32& value);
+        bool (*OnGetReactionTo)(const Unit* unit, const Unit* target, ReputationRank& outReaction);
+        bool (*OnGetSpellRank)(const Unit* unit, const SpellEntry* spellInfo, uint32& outSpellRank);
+
+        // Takes the hooks declared by the modules of the set into account, call it after they change
+        void (*Subscribe)();
+        // Hooks implemented by at least one module of the set
+        std::bitset<MODULE_HOOK_COUNT> implemented;
+        // Modules of the set in the order their hooks get called
+        std::vector<Module*> modules;
+    };
+
+    // Hooks that have a dispatch function in ModuleStaticHooks
+    inline bool IsModuleStaticHook(ModuleHook hook)
+    {
+        switch (hook)
+        {
+            case ModuleHook::OnRegenerate:
+            case ModuleHook::OnGetAttackDistance:
+            case ModuleHook::OnDealDamage:
+            case ModuleHook::OnKill:
+            case ModuleHook::OnDealHeal:
+            case ModuleHook::OnSetPower:
+            case ModuleHook::OnGetReactionTo:
+            case ModuleHook::OnGetSpellRank:
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    // Compile time set of module classes, e.g. ModuleStaticSet<FooModule, BarModule>. Every class
+    // must have a single instance, and the hooks it implements must be public
+    template<typename... Modules>
+    class ModuleStaticSet
+    {
+    public:
+        // Finds the instances of the module classes among the registered modules
+        static const ModuleStaticHooks* Create(const std::vector<Module*>& registered)
+        {
+            instances = std::make_tuple(Find<Modules>(registered)...);
+            Subscribe();
+
+            static ModuleStaticHooks hooks;
+            hooks.Subscribe = &Subscribe;
+            hooks.OnRegenerate = &OnRegenerate;
+            hooks.OnGetAttackDistance = &OnGetAttackDistance;
+            hooks.OnDealDamage = &OnDealDamage;
+            hooks.OnKill = &OnKill;
+            hooks.OnDealHeal = &OnDealHeal;
+            hooks.OnSetPower = &OnSetPower;
+            hooks.OnGetReactionTo = &OnGetReactionTo;
+            hooks.OnGetSpellRank = &OnGetSpellRank;
+
+            hooks.implemented.reset();
+            hooks.implemented.set(static_cast<size_t>(ModuleHook::OnRegenerate), (MODULE_OVERRIDES_HOOK(Modules, OnRegenerate) || ...));
+            hooks.implemented.set(static_cast<size_t>(ModuleHook::OnGetAttackDistance), (MODULE_OVERRIDES_HOOK(Modules, OnGetAttackDistance) || ...));
+            hooks.implemented.set(static_cast<size_t>(ModuleHook::OnDealDamage), (MODULE_OVERRIDES_HOOK(Modules, OnDealDamage) || ...));
+            hooks.implemented.set(static_cast<size_t>(ModuleHook::OnKill), (MODULE_OVERRIDES_HOOK(Modules, OnKill) || ...));
+            hooks.implemented.set(static_cast<size_t>(ModuleHook::OnDealHeal), (MODULE_OVERRIDES_HOOK(Modules, OnDealHeal) || ...));
+            hooks.implemented.set(static_cast<size_t>(ModuleHook::OnSetPower), (MODULE_OVERRIDES_HOOK(Modules, OnSetPower) || ...));
+            hooks.implemented.set(static_cast<size_t>(ModuleHook::OnGetReactionTo), (MODULE_OVERRIDES_HOOK(Modules, OnGetReactionTo) || ...));
+            hooks.implemented.set(static_cast<size_t>(ModuleHook::OnGetSpellRank), (MODULE_OVERRIDES_HOOK(Modules, OnGetSpellRank) || ...));
+
+            hooks.modules.clear();
+            (AddInstance<Modules>(hooks.modules), ...);
+            return &hooks;
+        }
+
+    private:
+        template<typename T>
+        static T* Find(const std::vector<Module*>& registered)
+        {
+            // Only the exact class, the hooks of a subclass would be skipped by the qualified calls
+            for (Module* mod : registered)
+            {
+                if (typeid(*mod) == typeid(T))
+                {
+                    return static_cast<T*>(mod);
+                }
+            }
+
+            return nullptr;
+        }
+
+        template<typename T>
+        static void AddInstance(std::vector<Module*>& modules)
+        {
+            if (T* mod = std::get<T*>(instances))
+            {
+                modules.push_back(mod);
+            }
+        }
+
+        static void Subscribe()
+        {
+            for (size_t i = 0; i < MODULE_HOOK_COUNT; ++i)
+            {
+                subscribers[i] = std::make_tuple(Subscriber<Modules>(static_cast<ModuleHook>(i))...);
+            }
+        }
+
+        template<typename T>
+        static T* Subscriber(ModuleHook hook)
+        {
+            T* mod = std::get<T*>(instances);
+            return mod && mod->HasHook(hook) ? mod : nullptr;
+        }
+
+        // Instance of the module class if it has the hook
+        template<typename T>
+        static T* Get(ModuleHook hook) { return std::get<T*>(subscribers[static_cast<size_t>(hook)]); }
+
+        // The qualified calls are not virtual, and the ones of the classes that don't
+        // implement the hook end up in the empty body of Module
+        static void OnRegenerate(Player* player, uint8 power, uint32 diff, float& addedValue)
+        {
+            ((Get<Modules>(ModuleHook::OnRegenerate) ? Get<Modules>(ModuleHook::OnRegenerate)->Modules::OnRegenerate(player, power, diff, addedValue) : void()), ...);
+        }
+
+        static bool OnGetAttackDistance(const Unit* unit, const Unit* target, float& outDistance)
+        {
+            return ((Get<Modules>(ModuleHook::OnGetAttackDistance) && Get<Modules>(ModuleHook::OnGetAttackDistance)->Modules::OnGetAttackDistance(unit, target, outDistance)) || ...);
+        }
+
+        static void OnDealDamage(Unit* unit, Unit* victim, uint32 health, uint32 damage)
+        {
+            ((Get<Modules>(ModuleHook::OnDealDamage) ? Get<Modules>(ModuleHook::OnDealDamage)->Modules::OnDealDamage(unit, victim, health, damage) : void()), ...);
+        }
+
+        static void OnKill(Unit* unit, Unit* victim)
+        {
+            ((Get<Modules>(ModuleHook::OnKill) ? Get<Modules>(ModuleHook::OnKill)->Modules::OnKill(unit, victim) : void()), ...);
+        }
+
+        static void OnDealHeal(Unit* unit, Unit* victim, int32 gain, uint32 addHealth)
+        {
+            ((Get<Modules>(ModuleHook::OnDealHeal) ? Get<Modules>(ModuleHook::OnDealHeal)->Modules::OnDealHeal(unit, victim, gain, addHealth) : void()), ...);
+        }
+
+        static void OnSetPower(Unit* unit, uint8 power, uint32& value)
+        {
+            ((Get<Modules>(ModuleHook::OnSetPower) ? Get<Modules>(ModuleHook::OnSetPower)->Modules::OnSetPower(unit, power, value) : void()), ...);
+        }
+
+        static bool OnGetReactionTo(const Unit* unit, const Unit* target, ReputationRank& outReaction)
+        {
+            return ((Get<Modules>(ModuleHook::OnGetReactionTo) && Get<Modules>(ModuleHook::OnGetReactionTo)->Modules::OnGetReactionTo(unit, target, outReaction)) || ...);
+        }
+
+        static bool OnGetSpellRank(const Unit* unit, const SpellEntry* spellInfo, uint32& outSpellRank)
+        {
+            return ((Get<Modules>(ModuleHook::OnGetSpellRank) && Get<Modules>(ModuleHook::OnGetSpellRank)->Modules::OnGetSpellRank(unit, spellInfo, outSpellRank)) || ...);
+        }
+
+    private:
+        static std::tuple<Modules*...> instances;
+        static std::array<std::tuple<Modules*...>, MODULE_HOOK_COUNT> subscribers;
+    };
+
+    template<typename... Modules>
+    std::tuple<Modules*...> ModuleStaticSet<Modules...>::instances;
+
+    template<typename... Modules>
+    std::array<std::tuple<Modules*...>, MODULE_HOOK_COUNT> ModuleStaticSet<Modules...>::subscribers;
+}
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef CMANGOS_MODULE_THREADING_H
+#define CMANGOS_MODULE_THREADING_H
+
+#include "Platform/Define.h"
+#include "Maps/Map.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace cmangos_module
+{
+    // Module state kept per map instance. Hooks running on the map update threads (see
+    // GetModuleHookThread) can use it without locking each other out, as long as each map
+    // state is only accessed from the thread updating that map, e.g.
+    // ModuleMapState<KillStreaks> killStreaks; ... killStreaks.Get(unit->GetMap()).Add(unit);
+    template<typename T>
+    class ModuleMapState
+    {
+    public:
+        ModuleMapState() : generation(NextGeneration()) {}
+
+        // Returns the state of the given map, creating it on first use
+        T& Get(const Map* map)
+        {
+            const uint64 key = GetKey(map);
+
+            // Every thread remembers the last map it accessed, which is the map it is updating
+            ThreadCache& cache = GetThreadCache();
+            const uint64 currentGeneration = generation.load(std::memory_order_acquire);
+            if (cache.owner == this && cache.key == key && cache.generation == currentGeneration)
+            {
+                return *cache.state;
+            }
+
+            T* state = nullptr;
+            {
+                std::shared_lock<std::shared_mutex> guard(lock);
+                auto stateIt = states.find(key);
+                if (stateIt != states.end())
+                {
+                    state = stateIt->second.get();
+                }
+            }
+
+            if (!state)
+            {
+                std::unique_lock<std::shared_mutex> guard(lock);
+                std::unique_ptr<T>& newState = states[key];
+                if (!newState)
+                {
+                    newState = std::make_unique<T>();
+                }
+
+                state = newState.get();
+            }
+
+            cache = { this, key, currentGeneration, state };
+            return *state;
+        }
+
+        // Removes the state of a map (e.g. after an instance gets unloaded). Must not be
+        // called while the map is being updated
+        void Remove(uint32 mapId, uint32 instanceId)
+        {
+            std::unique_lock<std::shared_mutex> guard(lock);
+            states.erase(GetKey(mapId, instanceId));
+            generation.store(NextGeneration(), std::memory_order_release);
+        }
+
+        // Removes the state of every map. Must be called from the world thread
+        void Clear()
+        {
+            std::unique_lock<std::shared_mutex> guard(lock);
+            states.clear();
+            generation.store(NextGeneration(), std::memory_order_release);
+        }
+
+        // Calls the visitor for every map state. Must be called from the world thread
+        template<typename Visitor>
+        void ForEach(Visitor&& visitor)
+        {
+            std::shared_lock<std::shared_mutex> guard(lock);
+            for (auto& statePair : states)
+            {
+                visitor(*statePair.second);
+            }
+        }
+
+    private:
+        struct ThreadCache
+        {
+            const ModuleMapState* owner;
+            uint64 key;
+            uint64 generation;
+            T* state;
+        };
+
+        static ThreadCache& GetThreadCache()
+        {
+            static thread_local ThreadCache cache = { nullptr, 0, 0, nullptr };
+            return cache;
+        }
+
+        // Generations are unique between instances so a new instance allocated where
+        // a destroyed one was can't match the stale cache of a thread
+        static uint64 NextGeneration()
+        {
+            static std::atomic<uint64> nextGeneration(1);
+            return nextGeneration.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        static uint64 GetKey(uint32 mapId, uint32 instanceId) { return (uint64(instanceId) << 32) | mapId; }
+        static uint64 GetKey(const Map* map) { return map ? GetKey(map->GetId(), map->GetInstanceId()) : 0; }
+
+    private:
+        mutable std::shared_mutex lock;
+        std::unordered_map<uint64, std::unique_ptr<T>> states;
+        std::atomic<uint64> generation;
+    };
+
+    namespace helper
+    {
+        // Returns an empty thread local container to be used as temporary storage within a
+        // hook, keeping its capacity between calls. Use a different tag for nested uses, e.g.
+        // std::vector<Unit*>& targets = GetThreadScratch<std::vector<Unit*>>();
+        template<typename T, typename Tag = void>
+        T& GetThreadScratch()
+        {
+            static thread_local T scratch;
+            scratch.clear();
+            return scratch;
+        }
+    }
+}
+
+#endif
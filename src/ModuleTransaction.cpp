@@ -0,0 +1,75 @@
+#include "ModuleTransaction.h"
+
+#include "Database/DatabaseEnv.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+namespace cmangos_module
+{
+    std::string& ModuleTransaction::NextStatement()
+    {
+        if (count == statements.size())
+        {
+            statements.emplace_back();
+        }
+
+        std::string& statement = statements[count++];
+        statement.clear();
+        return statement;
+    }
+
+    void ModuleTransaction::Execute(const char* sql)
+    {
+        if (sql && *sql)
+        {
+            NextStatement().assign(sql);
+        }
+    }
+
+    void ModuleTransaction::PExecute(const char* format, ...)
+    {
+        if (!format)
+        {
+            return;
+        }
+
+        va_list ap;
+        va_start(ap, format);
+        va_list apCopy;
+        va_copy(apCopy, ap);
+        const int length = vsnprintf(nullptr, 0, format, apCopy);
+        va_end(apCopy);
+
+        if (length > 0)
+        {
+            std::string& statement = NextStatement();
+            statement.resize(length + 1);
+            vsnprintf(&statement[0], statement.size(), format, ap);
+            statement.resize(length);
+        }
+
+        va_end(ap);
+    }
+
+    void ModuleTransaction::Commit(Database& database)
+    {
+        if (count)
+        {
+            database.BeginTransaction();
+            for (uint32 i = 0; i < count; ++i)
+            {
+                database.Execute(statements[i].c_str());
+            }
+
+            database.CommitTransaction();
+            count = 0;
+        }
+    }
+
+    ModuleTransaction& ModuleTransaction::GetThreadTransaction()
+    {
+        static thread_local ModuleTransaction transaction;
+        return transaction;
+    }
+}
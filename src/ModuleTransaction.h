@@ -0,0 +1,43 @@
+#ifndef CMANGOS_MODULE_TRANSACTION_H
+#define CMANGOS_MODULE_TRANSACTION_H
+
+#include "Platform/Define.h"
+
+#include <string>
+#include <vector>
+
+class Database;
+
+namespace cmangos_module
+{
+    // Collects the statements queued by the modules during a player save (or delete)
+    // so they are submitted as a single asynchronous transaction into the DB queue
+    class ModuleTransaction
+    {
+    public:
+        ModuleTransaction() : count(0) {}
+
+        void Execute(const char* sql);
+        void PExecute(const char* format, ...) ATTR_PRINTF(2, 3);
+
+        bool IsEmpty() const { return count == 0; }
+        uint32 GetSize() const { return count; }
+
+        // Submits the queued statements into the database as one transaction and clears them
+        void Commit(Database& database);
+        void Clear() { count = 0; }
+
+        // Per thread transaction reused between saves to avoid allocations
+        static ModuleTransaction& GetThreadTransaction();
+
+    private:
+        std::string& NextStatement();
+
+    private:
+        // Statements are kept after clearing to reuse their buffers
+        std::vector<std::string> statements;
+        uint32 count;
+    };
+}
+
+#endif
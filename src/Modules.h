@@ -3,4 +3,17 @@
 
 void AddModules();
 
+#ifdef MODULES_STATIC_DISPATCH
+#include <vector>
+
+namespace cmangos_module
+{
+    class Module;
+    struct ModuleStaticHooks;
+}
+
+// Generated together with AddModules() from the enabled modules (see ModuleStatic.h)
+const cmangos_module::ModuleStaticHooks* GetStaticModuleHooks(const std::vector<cmangos_module::Module*>& modules);
+#endif
+
 #endif
\ No newline at end of file